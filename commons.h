@@ -3,10 +3,25 @@
 #define COMMONS_H
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <limits.h>
+#include <locale.h>
+#include <sys/uio.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #define let __auto_type // type inference
 
@@ -29,6 +44,9 @@ typedef struct {\
 typedef enum {
     ERR_NONE = 0,
     ERR_INDEX_OUT_OF_BOUNDS = 1,
+    ERR_IO = 2,
+    ERR_INVALID_FORMAT = 3,
+    ERR_OUT_OF_RANGE = 4,
 } Err;
 
 // generic result type
@@ -94,7 +112,7 @@ dyn_##typename dyn_init_with_cap_##typename(size_t cap) {\
 */\
 dyn_##typename dyn_clone_##typename(dyn_##typename *self) {\
     T* buf = (T*)malloc(sizeof(T) * self->cap);\
-    memcpy(buf, self->buf, self->len);\
+    memcpy(buf, self->buf, sizeof(T) * self->len);\
     return (dyn_##typename){\
         .buf = buf,\
         .len = self->len,\
@@ -106,8 +124,8 @@ dyn_##typename dyn_clone_##typename(dyn_##typename *self) {\
     NOTE: you usually won't have to use this function yourself
 */\
 void dyn_resize_##typename(dyn_##typename *self) {\
-    self->cap *= 2;\
-    self->buf = (T*)realloc(self->buf, self->cap);\
+    self->cap = self->cap ? self->cap * 2 : 1;\
+    self->buf = (T*)realloc(self->buf, sizeof(T) * self->cap);\
 }\
 /*
     resizes dynamic array but with a specified addition
@@ -115,7 +133,7 @@ void dyn_resize_##typename(dyn_##typename *self) {\
 */\
 void dyn_resize_with_add_##typename(dyn_##typename *self, size_t addition) {\
     self->cap = self->cap * 2 + addition;\
-    self->buf = (T*)realloc(self->buf, self->cap);\
+    self->buf = (T*)realloc(self->buf, sizeof(T) * self->cap);\
 }\
 /* 
     returns the elem at index as an option
@@ -123,7 +141,7 @@ void dyn_resize_with_add_##typename(dyn_##typename *self, size_t addition) {\
 */\
 option_##typename dyn_at_##typename(dyn_##typename *self, size_t index) {\
     if (index >= self->len) {\
-        return (option_##typename){.ok = false, .value = 0};\
+        return (option_##typename){.ok = false};\
     }\
     return (option_##typename){.ok = true, .value = self->buf[index]};\
 }\
@@ -183,6 +201,328 @@ struct_option(T, typename)\
 struct_result(T, typename)\
 gen_dyn(T, typename)
 
+// instantiations used by the rest of the library
+gen_dyn_with_deps(size_t, size_t);
+gen_dyn_with_deps(double, double);
+
+
+
+/* ################# SUBSTRING SEARCH ################# */
+
+
+
+// returned by the search functions when there is no match
+#define STR_NPOS ((size_t)-1)
+// patterns longer than this skip the simd filter and go straight to two way
+#define STR_SEARCH_SIMD_MAX 32
+
+/*
+    maximal suffix of needle under the normal (reverse = false) or reversed alphabet order, used by two way
+    returns the start of the suffix minus one and writes its period
+    NOTE: you usually won't have to call this yourself
+*/
+ptrdiff_t str_search_maximal_suffix(const unsigned char* needle, size_t needle_len, size_t* period, bool reverse) {
+    ptrdiff_t suffix = -1;
+    size_t j = 0;
+    size_t k = 1;
+    size_t p = 1;
+    while (j + k < needle_len) {
+        unsigned char a = needle[j + k];
+        unsigned char b = needle[suffix + k];
+        if (reverse ? a > b : a < b) {
+            j += k;
+            k = 1;
+            p = j - suffix;
+        } else if (a == b) {
+            if (k != p) {
+                k += 1;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            suffix = j;
+            j = suffix + 1;
+            k = p = 1;
+        }
+    }
+    *period = p;
+    return suffix;
+}
+// a needle factorised for two way search, so repeated searches with it skip the setup
+typedef struct {
+    const unsigned char* needle;
+    ptrdiff_t len;
+    // the critical factorisation splits the needle after ell
+    ptrdiff_t ell;
+    ptrdiff_t period;
+    bool periodic;
+} str_two_way;
+
+/*
+    computes the critical factorisation of needle in O(m), the needle must outlive the result
+    NOTE: needle_len must be > 0, you usually won't have to call this yourself
+*/
+str_two_way str_two_way_init(const char* needle, size_t needle_len) {
+    const unsigned char* x = (const unsigned char*)needle;
+    ptrdiff_t m = (ptrdiff_t)needle_len;
+    size_t p, q;
+    ptrdiff_t i = str_search_maximal_suffix(x, needle_len, &p, false);
+    ptrdiff_t j = str_search_maximal_suffix(x, needle_len, &q, true);
+    ptrdiff_t ell = i > j ? i : j;
+    ptrdiff_t period = i > j ? (ptrdiff_t)p : (ptrdiff_t)q;
+    bool periodic = ell + 1 + period <= m && memcmp(x, x + period, ell + 1) == 0;
+    if (!periodic) {
+        period = (ell + 1 > m - ell - 1 ? ell + 1 : m - ell - 1) + 1;
+    }
+    return (str_two_way){.needle = x, .len = m, .ell = ell, .period = period, .periodic = periodic};
+}
+/*
+    crochemore perrin two way scan from *at, O(n + m) time and O(1) space whatever the input
+    returns the index of the next match or STR_NPOS
+    on a match *at and *memory are left on the next candidate, so calling again finds the next (possibly overlapping) match
+    start with *memory = -1, and reset it to -1 whenever *at is moved by hand
+    NOTE: you usually won't have to call this yourself
+*/
+size_t str_two_way_next(const str_two_way* self, const char* haystack, size_t haystack_len, size_t* at, ptrdiff_t* memory) {
+    const unsigned char* h = (const unsigned char*)haystack;
+    const unsigned char* x = self->needle;
+    ptrdiff_t m = self->len;
+    ptrdiff_t n = (ptrdiff_t)haystack_len;
+    ptrdiff_t ell = self->ell;
+    ptrdiff_t period = self->period;
+    ptrdiff_t j = (ptrdiff_t)*at;
+    ptrdiff_t i;
+
+    if (self->periodic) {
+        // periodic needle, remember how much of the right half already matched after a shift by the period
+        ptrdiff_t remembered = *memory;
+        while (j <= n - m) {
+            i = (ell > remembered ? ell : remembered) + 1;
+            while (i < m && x[i] == h[i + j]) {
+                i += 1;
+            }
+            if (i < m) {
+                j += i - ell;
+                remembered = -1;
+                continue;
+            }
+            i = ell;
+            while (i > remembered && x[i] == h[i + j]) {
+                i -= 1;
+            }
+            if (i <= remembered) {
+                *at = (size_t)(j + period);
+                *memory = m - period - 1;
+                return (size_t)j;
+            }
+            j += period;
+            remembered = m - period - 1;
+        }
+    } else {
+        while (j <= n - m) {
+            i = ell + 1;
+            while (i < m && x[i] == h[i + j]) {
+                i += 1;
+            }
+            if (i < m) {
+                j += i - ell;
+                continue;
+            }
+            i = ell;
+            while (i >= 0 && x[i] == h[i + j]) {
+                i -= 1;
+            }
+            if (i < 0) {
+                *at = (size_t)(j + period);
+                *memory = -1;
+                return (size_t)j;
+            }
+            j += period;
+        }
+    }
+    *at = haystack_len;
+    *memory = -1;
+    return STR_NPOS;
+}
+/*
+    crochemore perrin two way search, O(n + m) time and O(1) space whatever the input
+    returns the index of the first match or STR_NPOS
+    NOTE: needle_len must be > 0, you usually want str_search
+*/
+size_t str_search_two_way(const char* haystack, size_t haystack_len, const char* needle, size_t needle_len) {
+    if (needle_len > haystack_len) {
+        return STR_NPOS;
+    }
+    str_two_way two_way = str_two_way_init(needle, needle_len);
+    size_t at = 0;
+    ptrdiff_t memory = -1;
+    return str_two_way_next(&two_way, haystack, haystack_len, &at, &memory);
+}
+/*
+    memchr for the first byte then memcmp for the rest, used for tails and when there is no simd
+    NOTE: needle_len must be > 0, you usually want str_search
+*/
+size_t str_search_scalar(const char* haystack, size_t haystack_len, const char* needle, size_t needle_len) {
+    if (needle_len > haystack_len) {
+        return STR_NPOS;
+    }
+    const char* last = haystack + haystack_len - needle_len;
+    for (const char* at = haystack; at <= last; at++) {
+        at = (const char*)memchr(at, needle[0], last - at + 1);
+        if (!at) {
+            break;
+        }
+        if (memcmp(at + 1, needle + 1, needle_len - 1) == 0) {
+            return (size_t)(at - haystack);
+        }
+    }
+    return STR_NPOS;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+/*
+    generic simd search, compares 32 (avx2) or 16 (sse2) positions at once against the first and last needle byte
+    only positions where both match get a memcmp of the middle
+    NOTE: needle_len must be >= 2, you usually want str_search
+*/
+size_t str_search_simd(const char* haystack, size_t haystack_len, const char* needle, size_t needle_len) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    for (; i + needle_len - 1 + 32 <= haystack_len; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(haystack + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i*)(haystack + i + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first, block_first),
+            _mm256_cmpeq_epi8(last, block_last)
+        ));
+        while (mask) {
+            size_t at = i + __builtin_ctz(mask);
+            if (memcmp(haystack + at + 1, needle + 1, needle_len - 2) == 0) {
+                return at;
+            }
+            mask &= mask - 1;
+        }
+    }
+#else
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    for (; i + needle_len - 1 + 16 <= haystack_len; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(haystack + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(haystack + i + needle_len - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(first, block_first),
+            _mm_cmpeq_epi8(last, block_last)
+        ));
+        while (mask) {
+            size_t at = i + __builtin_ctz(mask);
+            if (memcmp(haystack + at + 1, needle + 1, needle_len - 2) == 0) {
+                return at;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    size_t found = str_search_scalar(haystack + i, haystack_len - i, needle, needle_len);
+    return found == STR_NPOS ? STR_NPOS : i + found;
+}
+#endif
+
+/*
+    finds the first occurrence of needle in haystack, neither needs to be null terminated
+    single bytes use memchr, short needles use the simd first/last byte filter and long needles use two way
+    returns the index of the first match or STR_NPOS, an empty needle matches at 0
+*/
+size_t str_search(const char* haystack, size_t haystack_len, const char* needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return 0;
+    }
+    if (needle_len > haystack_len) {
+        return STR_NPOS;
+    }
+    if (needle_len == 1) {
+        const char* found = (const char*)memchr(haystack, needle[0], haystack_len);
+        return found ? (size_t)(found - haystack) : STR_NPOS;
+    }
+    if (needle_len > STR_SEARCH_SIMD_MAX) {
+        return str_search_two_way(haystack, haystack_len, needle, needle_len);
+    }
+#if defined(__AVX2__) || defined(__SSE2__)
+    return str_search_simd(haystack, haystack_len, needle, needle_len);
+#else
+    return str_search_scalar(haystack, haystack_len, needle, needle_len);
+#endif
+}
+
+
+
+/* ################# ASCII CASE ################# */
+
+
+
+/* ascii only tolower, bytes outside 'A'..'Z' are left alone */
+char ascii_lower(char c) {
+    return (unsigned char)(c - 'A') < 26 ? c | 0x20 : c;
+}
+/* ascii only toupper, bytes outside 'a'..'z' are left alone */
+char ascii_upper(char c) {
+    return (unsigned char)(c - 'a') < 26 ? c & ~0x20 : c;
+}
+#if defined(__AVX2__)
+/*
+    flips the case bit of every byte in [first, first + 26) across 32 bytes
+    adding 0x80 - first moves the range to the bottom of the signed bytes so one signed compare finds it
+*/
+__m256i ascii_flip_case_256(__m256i block, char first) {
+    __m256i shifted = _mm256_add_epi8(block, _mm256_set1_epi8((char)(0x80 - first)));
+    __m256i in_range = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + 26)), shifted);
+    return _mm256_xor_si256(block, _mm256_and_si256(in_range, _mm256_set1_epi8(0x20)));
+}
+#endif
+#if defined(__SSE2__)
+/* same as ascii_flip_case_256 for 16 bytes */
+__m128i ascii_flip_case_128(__m128i block, char first) {
+    __m128i shifted = _mm_add_epi8(block, _mm_set1_epi8((char)(0x80 - first)));
+    __m128i in_range = _mm_cmpgt_epi8(_mm_set1_epi8((char)(0x80 + 26)), shifted);
+    return _mm_xor_si128(block, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+}
+#endif
+/*
+    flips the case of every byte in [first, first + 26), 32 bytes per step with avx2
+    first is 'A' to lowercase and 'a' to uppercase
+    NOTE: you usually want ascii_lower_bytes or ascii_upper_bytes
+*/
+void ascii_flip_case_bytes(char* data, size_t len, char first) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        _mm256_storeu_si256((__m256i*)(data + i), ascii_flip_case_256(block, first));
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), ascii_flip_case_128(block, first));
+    }
+#endif
+    for (; i < len; i++) {
+        if ((unsigned char)(data[i] - first) < 26) {
+            data[i] ^= 0x20;
+        }
+    }
+}
+/* lowercases 'A'..'Z' in place, doesn't depend on the locale and never touches utf-8 multi byte sequences */
+void ascii_lower_bytes(char* data, size_t len) {
+    ascii_flip_case_bytes(data, len, 'A');
+}
+/* uppercases 'a'..'z' in place, doesn't depend on the locale and never touches utf-8 multi byte sequences */
+void ascii_upper_bytes(char* data, size_t len) {
+    ascii_flip_case_bytes(data, len, 'a');
+}
+
 
 
 /* ################# STRING ################# */
@@ -192,44 +532,121 @@ gen_dyn(T, typename)
 gen_dyn_with_deps(char, char);
 struct_tuple(bool, size_t, bool_size_t);
 
-// heap allocated string with null terminator
+// string with small string optimisation, always null terminated
+// short strings (up to STRING_INLINE_CAP chars) live inside the struct in .small, longer ones in the dynamic array .buf
+// the last byte of the struct tells the two apart: in heap mode it's the top byte of .buf.cap which is always 0,
+// in inline mode it has STRING_INLINE_FLAG set and the low bits hold the len
+// .hash caches string_hash for strings used as map keys, 0 means not computed yet and every mutator resets it
+// NOTE: use string_len and string_data rather than .buf directly since .buf is only valid for heap strings
+// NOTE: writing through string_data yourself leaves .hash stale, call string_set_len or set .hash to 0 after
 typedef struct {
-    dyn_char buf;
+    union {
+        dyn_char buf;
+        char small[sizeof(dyn_char)];
+    };
+    size_t hash;
 } string;
+#define STRING_TAG (sizeof(dyn_char) - 1)
+#define STRING_INLINE_FLAG 0x80
+#define STRING_INLINE_CAP (STRING_TAG - 1)
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "string's inline flag lives in the top byte of .buf.cap");
+
+/* returns true if the chars are stored inside the struct rather than on the heap */
+bool string_is_inline(const string *self) {
+    return (unsigned char)self->small[STRING_TAG] & STRING_INLINE_FLAG;
+}
+/* returns the number of chars, not counting the null terminator */
+size_t string_len(const string *self) {
+    if (string_is_inline(self)) {
+        return (unsigned char)self->small[STRING_TAG] & ~STRING_INLINE_FLAG;
+    }
+    return self->buf.len;
+}
+/* returns the number of chars that fit without reallocating, not counting the null terminator */
+size_t string_cap(const string *self) {
+    if (string_is_inline(self)) {
+        return STRING_INLINE_CAP;
+    }
+    return self->buf.cap - 1;
+}
+/* returns a pointer to the first char, valid until the string is next resized or moved */
+char* string_data(string *self) {
+    if (string_is_inline(self)) {
+        return self->small;
+    }
+    return self->buf.buf;
+}
+/*
+    sets the len and writes the null terminator
+    NOTE: you usually won't have to call this yourself, len must be <= string_cap
+*/
+void string_set_len(string *self, size_t len) {
+    self->hash = 0;
+    if (string_is_inline(self)) {
+        self->small[len] = 0;
+        self->small[STRING_TAG] = (char)(STRING_INLINE_FLAG | len);
+    } else {
+        self->buf.buf[len] = 0;
+        self->buf.len = len;
+    }
+}
 /*
-    initalise a string that is just a dynamic array of chars
+    initalise an empty string, nothing is allocated until it grows past STRING_INLINE_CAP chars
 
-    NOTE: call string_deinit to free and sets .buf.len = 0, .buf.cap = 0
+    NOTE: call string_deinit to free
 
     returns a string
 */
 string string_init() {
-    return (string){ .buf = dyn_init_char() };
+    string self = {0};
+    self.small[STRING_TAG] = (char)STRING_INLINE_FLAG;
+    return self;
+}
+/*
+    makes sure there is room for n more chars plus the null terminator, growing at most once
+    grows to at least double the capacity so repeated small reserves stay amortised O(1)
+    moves the string to the heap once it no longer fits inline
+*/
+void string_reserve(string *self, size_t n) {
+    size_t len = string_len(self);
+    size_t needed = len + n + 1;
+    if (needed <= string_cap(self) + 1) {
+        return;
+    }
+    if (string_is_inline(self)) {
+        size_t cap = needed > 32 ? needed : 32;
+        char* buf = (char*)malloc(cap);
+        memcpy(buf, self->small, len + 1);
+        self->buf = (dyn_char){.buf = buf, .len = len, .cap = cap};
+        return;
+    }
+    size_t cap = self->buf.cap * 2;
+    if (cap < needed) {
+        cap = needed;
+    }
+    self->buf.buf = (char*)realloc(self->buf.buf, cap);
+    self->buf.cap = cap;
 }
 /*
     resize the string with a growth factor of 2
     NOTE: you usually won't have to call this yourself
 */
 void string_resize(string *self) {
-    dyn_resize_char(&self->buf);
+    string_reserve(self, string_cap(self) - string_len(self) + 1);
+}
+/* returns the string buf and can be used like a cstring since it also contains a null terminator */
+const char* string_cstr(const string *self) {
+    return string_data((string*)self);
 }
 /*
-    allocates a new string .buf
-
-    NOTE: call string_deinit to free and sets .len = 0, .cap = 0
-
-    returns newly allocated string
+    returns the string buf of a heap string, takes the string by value so rvalues and function pointers work
+    inline strings (up to STRING_INLINE_CAP chars) keep their chars in the copy itself, which is gone once this returns
+    so for them this returns NULL, use string_cstr(&self) to get the chars of any string
 */
-string string_clone(string *self) {
-    string new_str = (string){ .buf = dyn_clone_char(&self->buf) };
-    if (new_str.buf.len + 1 >= new_str.buf.cap) {
-        string_resize(self);
-    }
-    new_str.buf.buf[new_str.buf.len] = 0;
-    return new_str;
-}
-/* returns the string buf and can be used like a cstring since it also contains a null terminator */
 const char* string_get(string self) {
+    if (string_is_inline(&self)) {
+        return NULL;
+    }
     return self.buf.buf;
 }
 /* 
@@ -237,67 +654,148 @@ const char* string_get(string self) {
     if index is out of bounds, returns .ok = false
 */
 option_char string_at(string* self, size_t index) {
-    return dyn_at_char(&self->buf, index);
+    if (index >= string_len(self)) {
+        return (option_char){.ok = false, .value = 0};
+    }
+    return (option_char){.ok = true, .value = string_data(self)[index]};
 }
 /* 
-    string_push_char pushes the element but also pushes 0 to ensure it is null terminated
-    self->buf.len -= 1; because dyn_push increases the len but we don't count 0 as part of the len
+    string_push_char pushes the element but also writes 0 after it to ensure it is null terminated
+    the 0 isn't counted as part of the len
 */
 void string_push_char(string* self, char elem) {
-    dyn_push_char(&self->buf, elem);
-    dyn_push_char(&self->buf, 0);
-    self->buf.len -= 1;
+    string_reserve(self, 1);
+    size_t len = string_len(self);
+    string_data(self)[len] = elem;
+    string_set_len(self, len + 1);
+}
+/*
+    string_push_bytes pushes len bytes from content, content doesn't need to be null terminated
+    reserves once and copies with a single memcpy, also ensures that the ending string is null terminated
+*/
+void string_push_bytes(string* self, const char* content, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    char* data = string_data(self);
+    size_t self_len = string_len(self);
+    // content may point into self, so find it again after a realloc or a move to the heap
+    if (content >= data && content < data + self_len) {
+        size_t offset = content - data;
+        string_reserve(self, len);
+        content = string_data(self) + offset;
+    } else {
+        string_reserve(self, len);
+    }
+    memcpy(string_data(self) + self_len, content, len);
+    string_set_len(self, self_len + len);
 }
 /* 
     string_push_cstr pushes a c string that needs to be null terminated
     also ensures that the ending string is null terminated
 */
 void string_push_cstr(string* self, const char* content) {
-    for (size_t i = 0; i < strlen(content); i++) {
-        if (self->buf.len + 1 >= self->buf.cap) {
-            string_resize(self);
-        }
-        string_push_char(self, content[i]);
-    }
-    if (self->buf.len + 1 >= self->buf.cap) {
-        string_resize(self);
-    }
-    string_push_char(self, 0);
-    self->buf.len -= 1;
+    string_push_bytes(self, content, strlen(content));
 }
 /* 
-    this just calls string_push_cstr because it is guaranteed by the string functions to be null terminated
+    pushes the contents of another string, uses its len so there is no need to scan for the null terminator
 */
 void string_push_string(string *self, string content) {
-    string_push_cstr(self, content.buf.buf);
+    string_push_bytes(self, string_data(&content), string_len(&content));
+}
+/*
+    same as string_appendf but takes a va_list
+    NOTE: args is consumed twice when the first attempt doesn't fit, so it's copied with va_copy
+*/
+int string_vappendf(string *self, const char* fmt, va_list args) {
+    size_t len = string_len(self);
+    size_t room = string_cap(self) - len;
+    va_list retry;
+    va_copy(retry, args);
+    int written = vsnprintf(string_data(self) + len, room + 1, fmt, args);
+    if (written >= 0 && (size_t)written > room) {
+        string_reserve(self, (size_t)written);
+        written = vsnprintf(string_data(self) + len, (size_t)written + 1, fmt, retry);
+    }
+    va_end(retry);
+    if (written < 0) {
+        string_set_len(self, len);
+        return written;
+    }
+    string_set_len(self, len + (size_t)written);
+    return written;
+}
+/*
+    printf style formatting straight into the string's spare room, no temporary buffer
+    formats once into whatever room is left and only if that was too small, reserves the exact size and formats again
+    returns the number of chars pushed, or a negative value on an encoding error like vsnprintf
+    NOTE: the arguments must not point into self since it may be reallocated
+*/
+__attribute__((format(printf, 2, 3)))
+int string_appendf(string *self, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int written = string_vappendf(self, fmt, args);
+    va_end(args);
+    return written;
+}
+/*
+    allocates a new string .buf if the string doesn't fit inline
+
+    NOTE: call string_deinit to free
+
+    returns newly allocated string
+*/
+string string_clone(string *self) {
+    string new_str = string_init();
+    string_push_bytes(&new_str, string_data(self), string_len(self));
+    return new_str;
 }
+/* return pops out top element as an option */
 option_char string_pop(string *self) {
-    option_char elem = dyn_pop_char(&self->buf);
-    self->buf.buf[self->buf.len] = 0;
-    return elem;
+    size_t len = string_len(self);
+    if (len == 0) {
+        return (option_char){.ok = false, .value = 0};
+    }
+    char elem = string_data(self)[len - 1];
+    string_set_len(self, len - 1);
+    return (option_char){.ok = true, .value = elem};
 }
 /*
     removes a character at index from the string
 */
 option_char string_remove(string *self, size_t index) {
-    option_char elem = dyn_remove_char(&self->buf, index);
-    self->buf.buf[self->buf.len] = 0;
-    return elem;
+    size_t len = string_len(self);
+    if (index >= len) {
+        return (option_char){.ok = false, .value = 0};
+    }
+    char* data = string_data(self);
+    char elem = data[index];
+    memmove(data + index, data + index + 1, len - index - 1);
+    string_set_len(self, len - 1);
+    return (option_char){.ok = true, .value = elem};
 }
 /*
-    same as doing self->buf.buf[index] = elem but with bounds checking
+    same as doing string_data(self)[index] = elem but with bounds checking
     returns ERR_INDEX_OUT_OF_BOUNDS if index is well... out of bounds
 */
 result_char string_replace(string *self, size_t index, char elem) {
-    return dyn_replace_char(&self->buf, index, elem);
+    if (index >= string_len(self)) {
+        return (result_char){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    string_data(self)[index] = elem;
+    self->hash = 0;
+    return (result_char){.err = ERR_NONE};
 }
 /*
     if string does contain char, returns {true, index}
     else returns {false, 0}
 */
 tuple_bool_size_t string_contains_char(string self, char pattern) {
-    for (size_t i = 0; i < self.buf.len; i++) {
-        if (self.buf.buf[i] == pattern) {
+    const char* data = string_data(&self);
+    size_t len = string_len(&self);
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] == pattern) {
             return (tuple_bool_size_t){true, i};
         }
     }
@@ -309,43 +807,22 @@ tuple_bool_size_t string_contains_char(string self, char pattern) {
     else returns {false, 0}
 */
 tuple_bool_size_t string_contains_cstr(string self, const char *pattern) {
-    size_t head = 0;
-    size_t index = 0;
-    size_t pattern_len = strlen(pattern);
-
-    if (self.buf.len < pattern_len) {
+    size_t index = str_search(string_data(&self), string_len(&self), pattern, strlen(pattern));
+    if (index == STR_NPOS) {
         return (tuple_bool_size_t){false, 0};
     }
-
-    for (size_t i = 0; i < self.buf.len; i++) {
-        if (head == pattern_len) {
-            return (tuple_bool_size_t){true, index};
-        }
-
-        if (self.buf.buf[i] == pattern[head]) {
-            head += 1;
-        } else {
-            head = 0;
-            if (i == 0) {
-                index = 1;
-            } else {
-                index = i;
-            }
-        }
-    }
-
-    if (head == pattern_len) {
-        return (tuple_bool_size_t){true, index};
-    }
-
-    return (tuple_bool_size_t){false, 0};
+    return (tuple_bool_size_t){true, index};
 }
 /*
     if string does contain substring, returns {true, index} where index is the start of the pattern
     else returns {false, 0}
 */
 tuple_bool_size_t string_contains_string(string self, string pattern) {
-    return string_contains_cstr(self, pattern.buf.buf);
+    size_t index = str_search(string_data(&self), string_len(&self), string_data(&pattern), string_len(&pattern));
+    if (index == STR_NPOS) {
+        return (tuple_bool_size_t){false, 0};
+    }
+    return (tuple_bool_size_t){true, index};
 }
 /*
     create string type from cstr (must be null terminated)
@@ -358,221 +835,6392 @@ string string_from(const char* content) {
     string_push_cstr(&str, content);
     return str;
 }
+/*
+    create string type from len bytes at content, which may contain null bytes
+    i.e. string packet = string_from_bytes(buf, received);
+
+    NOTE: call string_deinit to free
+*/
+string string_from_bytes(const char* content, size_t len) {
+    string str = string_init();
+    string_push_bytes(&str, content, len);
+    return str;
+}
 /*
     compares the whole string to the comparate (must be null terminated)
     returns true if they're the same, false if not
 */
 bool string_compare_cstr(string self, const char* comparate) {
     size_t comparate_len = strlen(comparate);
-    if (self.buf.len != comparate_len) {
-        return false;
-    }
-
-    for (size_t i = 0; i < comparate_len; i++) {
-        if (self.buf.buf[i] != comparate[i]) {
-            return false;
-        }
-    }
-
-    return true;
+    return string_len(&self) == comparate_len && memcmp(string_data(&self), comparate, comparate_len) == 0;
 }
 /*
-    compares the whole string to the comparate (must be null terminated)
+    compares the whole string to the comparate, lengths first so different sized strings never touch the bytes
+    if both sides have a cached hash and they differ the bytes aren't touched either
     returns true if they're the same, false if not
 */
 bool string_compare_string(string self, string comparate) {
-    return string_compare_cstr(self, comparate.buf.buf);
+    size_t len = string_len(&self);
+    if (len != string_len(&comparate) || (self.hash && comparate.hash && self.hash != comparate.hash)) {
+        return false;
+    }
+    return memcmp(string_data(&self), string_data(&comparate), len) == 0;
+}
+/*
+    lexicographic byte order, for sorting, null bytes compare like any other byte
+    returns < 0 if self comes first, 0 if equal, > 0 if comparate comes first
+*/
+int string_cmp(const string *self, const string *comparate) {
+    size_t self_len = string_len(self);
+    size_t comparate_len = string_len(comparate);
+    size_t len = self_len < comparate_len ? self_len : comparate_len;
+    int order = len ? memcmp(string_cstr(self), string_cstr(comparate), len) : 0;
+    if (order != 0) {
+        return order;
+    }
+    return (self_len > comparate_len) - (self_len < comparate_len);
 }
 /*
     makes the whole string lowercase
+    only 'A'..'Z' are changed so utf-8 text stays intact, see ascii_lower_bytes
 */
 void string_lower(string *self) {
-    for (size_t i = 0; i < self->buf.len; i++) {
-        self->buf.buf[i] = tolower(self->buf.buf[i]);
-    }
+    ascii_lower_bytes(string_data(self), string_len(self));
+    self->hash = 0;
 }
 /*
     makes the whole string uppercase
+    only 'a'..'z' are changed so utf-8 text stays intact, see ascii_upper_bytes
 */
 void string_upper(string *self) {
-    for (size_t i = 0; i < self->buf.len; i++) {
-        self->buf.buf[i] = toupper(self->buf.buf[i]);
-    }
+    ascii_upper_bytes(string_data(self), string_len(self));
+    self->hash = 0;
 }
 void string_clear(string *self) {
-    dyn_clear_char(&self->buf);
+    string_set_len(self, 0);
 }
+/* frees the heap buffer if there is one and leaves an empty string behind */
 void string_deinit(string *self) {
-    dyn_deinit_char(&self->buf);
+    if (!string_is_inline(self)) {
+        free(self->buf.buf);
+    }
+    *self = string_init();
 }
 
 
 
-/* ################# MAP ################# */
+/* ################# STRING VIEW ################# */
 
 
 
-#define gen_map(K, V, typenames)\
-typedef struct {\
-    K key;\
-    V value;\
-    bool active;\
-} map_entry_##typenames;\
-gen_dyn_with_deps(map_entry_##typenames, map_entry_##typenames);\
-typedef struct {\
-    dyn_map_entry_##typenames entries;\
-    size_t active_count;\
-    size_t (*hash)(K);\
-    bool (*key_compare)(K, K);\
-} map_##typenames;\
+// non owning view into chars, not null terminated
+// .ptr points at the first char, .len is the number of chars
+// NOTE: the view is only valid while whatever it points into is alive and unchanged
+typedef struct {
+    const char* ptr;
+    size_t len;
+} str;
+struct_tuple(str, str, str_str);
+struct_option(tuple_str_str, str_str);
+
+/* view over len bytes at ptr */
+str str_from_bytes(const char* ptr, size_t len) {
+    return (str){.ptr = ptr, .len = len};
+}
+/* view over a null terminated c string, the terminator is not part of the view */
+str str_from_cstr(const char* cstr) {
+    return (str){.ptr = cstr, .len = strlen(cstr)};
+}
 /*
-    allocates a dynamic array with a starting capacity of 97. check readme for why specifically 97
-    NOTE: call map_deinit to free after use
-*/\
-map_##typenames map_init_##typenames(size_t hash(K), bool key_compare(K, K)) {\
-    return (map_##typenames){\
-        .entries = dyn_init_with_cap_map_entry_##typenames(97),\
-        .active_count = 0,\
-        .hash = hash,\
-        .key_compare = key_compare,\
-    };\
-}\
-void map_deinit_##typenames(map_##typenames *self) {\
-    dyn_deinit_map_entry_##typenames(&self->entries);\
-}\
+    view over the whole string
+    NOTE: takes a pointer because short strings live inside the struct, don't pass a temporary copy
+*/
+str string_as_str(const string *self) {
+    return (str){.ptr = string_cstr(self), .len = string_len(self)};
+}
+/* pushes the viewed chars onto the string */
+void string_push_str(string *self, str content) {
+    string_push_bytes(self, content.ptr, content.len);
+}
 /*
-    map_resize creates a new map and inserts the previous entries to the new one
+    create string type from a view, copying the chars
 
-    NOTE: old map is freed during this function, careful of dangling pointers
-*/\
-bool map_insert_##typenames(map_##typenames *self, K key, V value);\
-void map_resize_##typenames(map_##typenames *self) {\
-    map_##typenames new_map = {\
-        .entries = dyn_init_with_cap_map_entry_##typenames(self->entries.cap * 2 + 1),\
-        .active_count = 0,\
-    };\
-    for (size_t i = 0; i < self->entries.cap; i++) {\
-        if (self->entries.buf[i].active) {\
-            map_insert_##typenames(&new_map, self->entries.buf[i].key, self->entries.buf[i].value);\
-        }\
-    }\
-\
-    map_deinit_##typenames(self);\
-    *self = new_map;\
-}\
+    NOTE: call string_deinit to free
+*/
+string string_from_str(str content) {
+    string self = string_init();
+    string_push_str(&self, content);
+    return self;
+}
 /*
-    returns false if key isn't unqiue
-*/\
-bool map_insert_##typenames(map_##typenames *self, K key, V value) {\
-    if (self->active_count >= self->entries.cap) {\
-        map_resize_##typenames(self);\
-    }\
-    size_t index = self->hash(key) % self->entries.cap;\
-    while (self->entries.buf[index].active) {\
-        if (self->key_compare(self->entries.buf[index].key, key)) {\
-            return false;\
+    returns the view of [begin, end)
+    end is clamped to the len and begin is clamped to end, so out of range slices come back empty
+*/
+str str_slice(str self, size_t begin, size_t end) {
+    if (end > self.len) {
+        end = self.len;
+    }
+    if (begin > end) {
+        begin = end;
+    }
+    return (str){.ptr = self.ptr + begin, .len = end - begin};
+}
+/*
+    if view does contain char, returns {true, index}
+    else returns {false, 0}
+*/
+tuple_bool_size_t str_find_char(str self, char pattern) {
+    const char* found = self.len ? (const char*)memchr(self.ptr, pattern, self.len) : NULL;
+    if (!found) {
+        return (tuple_bool_size_t){false, 0};
+    }
+    return (tuple_bool_size_t){true, (size_t)(found - self.ptr)};
+}
+/*
+    if view does contain pattern, returns {true, index} where index is the start of the first match
+    else returns {false, 0}
+    an empty pattern matches at 0
+*/
+tuple_bool_size_t str_find(str self, str pattern) {
+    size_t index = str_search(self.ptr, self.len, pattern.ptr, pattern.len);
+    if (index == STR_NPOS) {
+        return (tuple_bool_size_t){false, 0};
+    }
+    return (tuple_bool_size_t){true, index};
+}
+/* returns true if both views hold the same chars */
+bool str_compare(str self, str comparate) {
+    return self.len == comparate.len && memcmp(self.ptr, comparate.ptr, self.len) == 0;
+}
+/*
+    lexicographic byte order, for sorting
+    returns < 0 if self comes first, 0 if equal, > 0 if comparate comes first
+*/
+int str_cmp(str self, str comparate) {
+    size_t len = self.len < comparate.len ? self.len : comparate.len;
+    int order = len ? memcmp(self.ptr, comparate.ptr, len) : 0;
+    if (order != 0) {
+        return order;
+    }
+    return (self.len > comparate.len) - (self.len < comparate.len);
+}
+bool str_starts_with(str self, str prefix) {
+    return prefix.len <= self.len && memcmp(self.ptr, prefix.ptr, prefix.len) == 0;
+}
+bool str_ends_with(str self, str suffix) {
+    return suffix.len <= self.len && memcmp(self.ptr + self.len - suffix.len, suffix.ptr, suffix.len) == 0;
+}
+/*
+    splits the view around the first delim
+    returns {.one = before, .two = after} as an option
+    if delim isn't found, returns .ok = false
+*/
+option_str_str str_split_once(str self, str delim) {
+    tuple_bool_size_t found = str_find(self, delim);
+    if (!found.one) {
+        return (option_str_str){.ok = false};
+    }
+    return (option_str_str){.ok = true, .value = {
+        .one = str_slice(self, 0, found.two),
+        .two = str_slice(self, found.two + delim.len, self.len),
+    }};
+}
+// djb2 over the viewed bytes, a hashing function for str keys in a map
+size_t hash_str(str key) {
+    size_t hash = 5381;
+    for (size_t i = 0; i < key.len; i++) {
+        hash = ((hash << 5) + hash) + key.ptr[i];
+    }
+    return hash;
+}
+/*
+    hashes the string once and caches it in .hash until the next mutation
+    same as hash_str except a hash of 0 is stored as 1 since 0 means not cached
+*/
+size_t string_hash(string *self) {
+    if (self->hash == 0) {
+        size_t hash = hash_str(string_as_str(self));
+        self->hash = hash ? hash : 1;
+    }
+    return self->hash;
+}
+/*
+    a hashing function for string keys, pair with string_compare_string
+    the by value copy still carries .hash, so a key that already went through string_hash isn't hashed again
+    call string_hash(&key) once on long lived keys before inserting or looking them up, otherwise every call hashes the whole key
+    i.e. map_string_int counts = map_init_string_int(hash_string, string_compare_string);
+*/
+size_t hash_string(string key) {
+    if (key.hash) {
+        return key.hash;
+    }
+    // same value string_hash would cache, so cached and uncached copies of a key land in the same bucket
+    size_t hash = hash_str(string_as_str(&key));
+    return hash ? hash : 1;
+}
+// walks the matches of one pattern through one view, preparing the pattern only once
+typedef struct {
+    str haystack;
+    str pattern;
+    // only used for patterns past STR_SEARCH_SIMD_MAX, shorter ones go through str_search each time
+    str_two_way two_way;
+    size_t at;
+    ptrdiff_t memory;
+} str_searcher;
+
+/*
+    prepares pattern for matching through haystack, neither is copied
+    NOTE: pattern.len must be > 0, you usually won't have to call this yourself
+*/
+str_searcher str_searcher_init(str haystack, str pattern) {
+    str_searcher self = {.haystack = haystack, .pattern = pattern, .at = 0, .memory = -1};
+    if (pattern.len > STR_SEARCH_SIMD_MAX) {
+        self.two_way = str_two_way_init(pattern.ptr, pattern.len);
+    }
+    return self;
+}
+/*
+    returns the start of the next match, overlapping the previous one if they do, or STR_NPOS
+    NOTE: you usually won't have to call this yourself
+*/
+size_t str_searcher_next(str_searcher* self) {
+    if (self->at + self->pattern.len > self->haystack.len) {
+        return STR_NPOS;
+    }
+    if (self->pattern.len > STR_SEARCH_SIMD_MAX) {
+        return str_two_way_next(&self->two_way, self->haystack.ptr, self->haystack.len, &self->at, &self->memory);
+    }
+    size_t index = str_search(self->haystack.ptr + self->at, self->haystack.len - self->at, self->pattern.ptr, self->pattern.len);
+    if (index == STR_NPOS) {
+        self->at = self->haystack.len;
+        return STR_NPOS;
+    }
+    index += self->at;
+    self->at = index + 1;
+    return index;
+}
+/*
+    makes the next match start at pos or later, used to skip past a match for non overlapping scans
+    NOTE: you usually won't have to call this yourself
+*/
+void str_searcher_seek(str_searcher* self, size_t pos) {
+    if (pos > self->at) {
+        self->at = pos;
+        self->memory = -1;
+    }
+}
+/*
+    returns the start of every match of pattern in the view, including overlapping ones ("aa" is found twice in "aaa")
+    an empty pattern has no matches
+
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t str_find_all(str self, str pattern) {
+    dyn_size_t found = dyn_init_size_t();
+    if (pattern.len == 0) {
+        return found;
+    }
+    str_searcher searcher = str_searcher_init(self, pattern);
+    for (size_t index; (index = str_searcher_next(&searcher)) != STR_NPOS;) {
+        dyn_push_size_t(&found, index);
+    }
+    return found;
+}
+/* returns the number of matches of pattern in the view, counting overlapping ones like str_find_all */
+size_t str_count(str self, str pattern) {
+    size_t count = 0;
+    if (pattern.len == 0) {
+        return count;
+    }
+    str_searcher searcher = str_searcher_init(self, pattern);
+    while (str_searcher_next(&searcher) != STR_NPOS) {
+        count += 1;
+    }
+    return count;
+}
+/*
+    if string does contain pattern, returns {true, index} where index is the start of the first match
+    else returns {false, 0}
+*/
+tuple_bool_size_t string_find(const string *self, str pattern) {
+    return str_find(string_as_str(self), pattern);
+}
+/*
+    same as str_find_all over the whole string
+
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t string_find_all(const string *self, str pattern) {
+    return str_find_all(string_as_str(self), pattern);
+}
+/* same as str_count over the whole string */
+size_t string_count(const string *self, str pattern) {
+    return str_count(string_as_str(self), pattern);
+}
+/* returns the number of non overlapping matches of pattern scanning left to right, the ones str_replace_all replaces */
+size_t str_count_disjoint(str self, str pattern) {
+    size_t count = 0;
+    if (pattern.len == 0) {
+        return count;
+    }
+    str_searcher searcher = str_searcher_init(self, pattern);
+    for (size_t index; (index = str_searcher_next(&searcher)) != STR_NPOS;) {
+        count += 1;
+        str_searcher_seek(&searcher, index + pattern.len);
+    }
+    return count;
+}
+/*
+    builds the result of replacing the first count non overlapping matches of from with to
+    the result is allocated once at its exact size
+    NOTE: you usually won't have to call this yourself, count must be at most str_count_disjoint(self, from)
+*/
+string str_replace_counted(str self, str from, str to, size_t count) {
+    string result = string_init();
+    size_t len = self.len - count * from.len + count * to.len;
+    string_reserve(&result, len);
+    char* out = string_data(&result);
+    size_t at = 0;
+    str_searcher searcher = str_searcher_init(self, from);
+    for (size_t i = 0; i < count; i++) {
+        size_t index = str_searcher_next(&searcher) - at;
+        memcpy(out, self.ptr + at, index);
+        out += index;
+        if (to.len) {
+            memcpy(out, to.ptr, to.len);
+        }
+        out += to.len;
+        at += index + from.len;
+        str_searcher_seek(&searcher, at);
+    }
+    if (self.len > at) {
+        memcpy(out, self.ptr + at, self.len - at);
+    }
+    string_set_len(&result, len);
+    return result;
+}
+/*
+    copy of the view with every non overlapping match of from (scanning left to right) replaced by to
+    one search pass counts the matches so the result is sized exactly, a second pass fills it in
+    an empty from matches nothing
+
+    NOTE: call string_deinit to free
+*/
+string str_replace_all(str self, str from, str to) {
+    return str_replace_counted(self, from, to, str_count_disjoint(self, from));
+}
+/*
+    replaces every non overlapping match of from with to, see str_replace_all
+    from and to may point into the string itself, nothing is allocated when there is no match
+    returns the number of replacements made
+*/
+size_t string_replace_all(string *self, str from, str to) {
+    size_t count = str_count_disjoint(string_as_str(self), from);
+    if (count == 0) {
+        return 0;
+    }
+    string result = str_replace_counted(string_as_str(self), from, to, count);
+    string_deinit(self);
+    *self = result;
+    return count;
+}
+/*
+    joins n views with sep between each, the lengths are summed first so the result is allocated once
+    i.e. string csv = str_join(fields.buf, fields.len, str_from_cstr(","));
+
+    NOTE: call string_deinit to free
+*/
+string str_join(const str* parts, size_t n, str sep) {
+    string result = string_init();
+    if (n == 0) {
+        return result;
+    }
+    size_t len = sep.len * (n - 1);
+    for (size_t i = 0; i < n; i++) {
+        len += parts[i].len;
+    }
+    string_reserve(&result, len);
+    char* out = string_data(&result);
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0 && sep.len) {
+            memcpy(out, sep.ptr, sep.len);
+            out += sep.len;
+        }
+        if (parts[i].len) {
+            memcpy(out, parts[i].ptr, parts[i].len);
+            out += parts[i].len;
+        }
+    }
+    string_set_len(&result, len);
+    return result;
+}
+/*
+    same as str_join over n strings, no strlen is needed since every string knows its len
+
+    NOTE: call string_deinit to free
+*/
+string string_join(const string* parts, size_t n, str sep) {
+    string result = string_init();
+    if (n == 0) {
+        return result;
+    }
+    size_t len = sep.len * (n - 1);
+    for (size_t i = 0; i < n; i++) {
+        len += string_len(&parts[i]);
+    }
+    string_reserve(&result, len);
+    char* out = string_data(&result);
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0 && sep.len) {
+            memcpy(out, sep.ptr, sep.len);
+            out += sep.len;
+        }
+        size_t part_len = string_len(&parts[i]);
+        memcpy(out, string_cstr(&parts[i]), part_len);
+        out += part_len;
+    }
+    string_set_len(&result, len);
+    return result;
+}
+/*
+    n strings one after another, same as string_join with an empty sep
+
+    NOTE: call string_deinit to free
+*/
+string string_concat_n(const string* parts, size_t n) {
+    return string_join(parts, n, str_from_bytes("", 0));
+}
+/* returns true if both views hold the same chars, ignoring ascii case */
+bool str_equal_ignore_case(str self, str comparate) {
+    if (self.len != comparate.len) {
+        return false;
+    }
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= self.len; i += 32) {
+        __m256i a = ascii_flip_case_256(_mm256_loadu_si256((const __m256i*)(self.ptr + i)), 'A');
+        __m256i b = ascii_flip_case_256(_mm256_loadu_si256((const __m256i*)(comparate.ptr + i)), 'A');
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) != 0xffffffffu) {
+            return false;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 16 <= self.len; i += 16) {
+        __m128i a = ascii_flip_case_128(_mm_loadu_si128((const __m128i*)(self.ptr + i)), 'A');
+        __m128i b = ascii_flip_case_128(_mm_loadu_si128((const __m128i*)(comparate.ptr + i)), 'A');
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xffff) {
+            return false;
+        }
+    }
+#endif
+    for (; i < self.len; i++) {
+        if (ascii_lower(self.ptr[i]) != ascii_lower(comparate.ptr[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+/* compares the whole string to comparate, ignoring ascii case */
+bool string_equal_ignore_case(const string *self, str comparate) {
+    return str_equal_ignore_case(string_as_str(self), comparate);
+}
+/*
+    same as str_find but ignoring ascii case
+    lowercases 32 haystack bytes at a time and filters on the first and last needle byte before comparing the rest
+*/
+tuple_bool_size_t str_find_ignore_case(str self, str pattern) {
+    if (pattern.len == 0) {
+        return (tuple_bool_size_t){true, 0};
+    }
+    if (pattern.len > self.len) {
+        return (tuple_bool_size_t){false, 0};
+    }
+    char first = ascii_lower(pattern.ptr[0]);
+    char last = ascii_lower(pattern.ptr[pattern.len - 1]);
+    str middle = str_slice(pattern, 1, pattern.len);
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i first_block = _mm256_set1_epi8(first);
+    const __m256i last_block = _mm256_set1_epi8(last);
+    for (; i + pattern.len - 1 + 32 <= self.len; i += 32) {
+        __m256i block_first = ascii_flip_case_256(_mm256_loadu_si256((const __m256i*)(self.ptr + i)), 'A');
+        __m256i block_last = ascii_flip_case_256(_mm256_loadu_si256((const __m256i*)(self.ptr + i + pattern.len - 1)), 'A');
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first_block, block_first),
+            _mm256_cmpeq_epi8(last_block, block_last)
+        ));
+        while (mask) {
+            size_t at = i + __builtin_ctz(mask);
+            if (str_equal_ignore_case(str_from_bytes(self.ptr + at + 1, middle.len), middle)) {
+                return (tuple_bool_size_t){true, at};
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + pattern.len <= self.len; i++) {
+        if (ascii_lower(self.ptr[i]) == first
+            && ascii_lower(self.ptr[i + pattern.len - 1]) == last
+            && str_equal_ignore_case(str_from_bytes(self.ptr + i + 1, middle.len), middle)) {
+            return (tuple_bool_size_t){true, i};
+        }
+    }
+    return (tuple_bool_size_t){false, 0};
+}
+/* same as str_find_ignore_case over the whole string */
+tuple_bool_size_t string_find_ignore_case(const string *self, str pattern) {
+    return str_find_ignore_case(string_as_str(self), pattern);
+}
+
+
+
+/* ################# SHARED STRING ################# */
+
+
+
+// heap block behind a shared_string, the chars (null terminated) follow the header
+typedef struct {
+    atomic_size_t refs;
+    size_t len;
+    size_t cap;
+    char data[];
+} shared_string_block;
+
+// immutable string that many owners can hold at once, cloning only bumps an atomic refcount
+// mutating goes through copy on write, so the other owners never see the change
+// .block is NULL for the empty string
+typedef struct {
+    shared_string_block* block;
+} shared_string;
+
+/*
+    allocates a block with room for cap chars plus the null terminator, holding one reference
+    NOTE: you usually won't have to call this yourself
+*/
+shared_string_block* shared_string_alloc(size_t cap) {
+    shared_string_block* block = (shared_string_block*)malloc(sizeof(shared_string_block) + cap + 1);
+    atomic_init(&block->refs, 1);
+    block->len = 0;
+    block->cap = cap;
+    block->data[0] = 0;
+    return block;
+}
+/*
+    initalise an empty shared string, nothing is allocated
+
+    NOTE: call shared_string_deinit to free
+*/
+shared_string shared_string_init() {
+    return (shared_string){.block = NULL};
+}
+/*
+    copies the view into a new shared string
+
+    NOTE: call shared_string_deinit to free
+*/
+shared_string shared_string_from_str(str content) {
+    if (content.len == 0) {
+        return shared_string_init();
+    }
+    shared_string_block* block = shared_string_alloc(content.len);
+    memcpy(block->data, content.ptr, content.len);
+    block->data[content.len] = 0;
+    block->len = content.len;
+    return (shared_string){.block = block};
+}
+/*
+    copies the string into a new shared string
+
+    NOTE: call shared_string_deinit to free
+*/
+shared_string shared_string_from_string(const string *content) {
+    return shared_string_from_str(string_as_str(content));
+}
+/*
+    another owner of the same chars in O(1), nothing is copied
+
+    NOTE: call shared_string_deinit to free
+*/
+shared_string shared_string_clone(const shared_string *self) {
+    if (self->block) {
+        // a new reference is made from an existing one, so nothing needs ordering here
+        atomic_fetch_add_explicit(&self->block->refs, 1, memory_order_relaxed);
+    }
+    return *self;
+}
+size_t shared_string_len(const shared_string *self) {
+    return self->block ? self->block->len : 0;
+}
+/* returns the null terminated chars, valid until this owner mutates or deinits */
+const char* shared_string_cstr(const shared_string *self) {
+    return self->block ? self->block->data : "";
+}
+str shared_string_as_str(const shared_string *self) {
+    return str_from_bytes(shared_string_cstr(self), shared_string_len(self));
+}
+/*
+    copies the chars into a plain string
+
+    NOTE: call string_deinit to free
+*/
+string shared_string_to_string(const shared_string *self) {
+    return string_from_str(shared_string_as_str(self));
+}
+/* returns true if no other owner holds the same chars */
+bool shared_string_is_unique(const shared_string *self) {
+    return !self->block || atomic_load_explicit(&self->block->refs, memory_order_acquire) == 1;
+}
+/*
+    drops this owner's reference, the block is freed by whoever drops the last one
+    leaves an empty shared string behind
+*/
+void shared_string_deinit(shared_string *self) {
+    if (self->block && atomic_fetch_sub_explicit(&self->block->refs, 1, memory_order_acq_rel) == 1) {
+        free(self->block);
+    }
+    self->block = NULL;
+}
+/*
+    makes sure this owner is the only one and there is room for n more chars, copying the chars if they are shared
+    returns a pointer to the chars that is safe to write to
+    NOTE: you usually won't have to call this yourself, the mutators below do
+*/
+char* shared_string_make_unique(shared_string *self, size_t n) {
+    size_t len = shared_string_len(self);
+    if (shared_string_is_unique(self) && self->block && self->block->cap - len >= n) {
+        return self->block->data;
+    }
+    size_t cap = self->block ? self->block->cap : 0;
+    if (cap - len < n) {
+        cap = cap * 2 > len + n ? cap * 2 : len + n;
+    }
+    if (shared_string_is_unique(self) && self->block) {
+        self->block = (shared_string_block*)realloc(self->block, sizeof(shared_string_block) + cap + 1);
+        self->block->cap = cap;
+        return self->block->data;
+    }
+    shared_string_block* block = shared_string_alloc(cap);
+    memcpy(block->data, shared_string_cstr(self), len + 1);
+    block->len = len;
+    shared_string_deinit(self);
+    self->block = block;
+    return block->data;
+}
+/* pushes the view, copying first if the chars are shared, content may point into the string */
+void shared_string_push_str(shared_string *self, str content) {
+    if (content.len == 0) {
+        return;
+    }
+    const char* old = shared_string_cstr(self);
+    size_t len = shared_string_len(self);
+    // content may point into the chars, so find it again after they are copied or reallocated
+    bool inside = content.ptr >= old && content.ptr < old + len;
+    size_t offset = inside ? (size_t)(content.ptr - old) : 0;
+    char* data = shared_string_make_unique(self, content.len);
+    if (inside) {
+        content.ptr = data + offset;
+    }
+    memcpy(data + len, content.ptr, content.len);
+    data[len + content.len] = 0;
+    self->block->len = len + content.len;
+}
+void shared_string_push_char(shared_string *self, char elem) {
+    shared_string_push_str(self, str_from_bytes(&elem, 1));
+}
+/*
+    same as string_replace, copying first if the chars are shared
+    returns ERR_INDEX_OUT_OF_BOUNDS if index is out of bounds
+*/
+result_char shared_string_replace(shared_string *self, size_t index, char elem) {
+    if (index >= shared_string_len(self)) {
+        return (result_char){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    shared_string_make_unique(self, 0)[index] = elem;
+    return (result_char){.err = ERR_NONE};
+}
+/* empties the string, only this owner's reference is dropped if the chars are shared */
+void shared_string_clear(shared_string *self) {
+    if (!shared_string_is_unique(self)) {
+        shared_string_deinit(self);
+        return;
+    }
+    if (self->block) {
+        self->block->len = 0;
+        self->block->data[0] = 0;
+    }
+}
+bool shared_string_compare(const shared_string *self, const shared_string *comparate) {
+    return self->block == comparate->block || str_compare(shared_string_as_str(self), shared_string_as_str(comparate));
+}
+
+
+
+/* ################# CHARACTER CLASSES ################# */
+
+
+
+#if defined(__AVX2__)
+#define CHARSET_BLOCK 32
+#else
+#define CHARSET_BLOCK 16
+#endif
+
+// set of bytes for scanning and trimming
+// .bits is the plain 256 bit table used for short tails
+// .lo/.hi are the nibble tables for pshufb: bit h of .lo[n] is set if byte (h << 4 | n) is in the set,
+// .hi is the same for the bytes 0x80..0xff
+typedef struct {
+    uint64_t bits[4];
+    unsigned char lo[16];
+    unsigned char hi[16];
+} charset;
+
+/* returns an empty set */
+charset charset_init() {
+    charset self;
+    memset(&self, 0, sizeof(self));
+    return self;
+}
+void charset_add(charset* self, char c) {
+    unsigned char byte = (unsigned char)c;
+    self->bits[byte / 64] |= (uint64_t)1 << (byte % 64);
+    if (byte < 0x80) {
+        self->lo[byte & 0x0f] |= (unsigned char)(1 << (byte >> 4));
+    } else {
+        self->hi[byte & 0x0f] |= (unsigned char)(1 << ((byte >> 4) - 8));
+    }
+}
+/* adds every byte from first to last inclusive */
+void charset_add_range(charset* self, char first, char last) {
+    for (unsigned c = (unsigned char)first; c <= (unsigned char)last; c++) {
+        charset_add(self, (char)c);
+    }
+}
+/*
+    set of every byte in chars
+    i.e. charset digits = charset_from(str_from_cstr("0123456789"));
+*/
+charset charset_from(str chars) {
+    charset self = charset_init();
+    for (size_t i = 0; i < chars.len; i++) {
+        charset_add(&self, chars.ptr[i]);
+    }
+    return self;
+}
+/* the bytes isspace accepts in the C locale, " \t\n\r\v\f" */
+charset charset_whitespace() {
+    return charset_from(str_from_cstr(" \t\n\r\v\f"));
+}
+bool charset_contains(const charset* self, char c) {
+    unsigned char byte = (unsigned char)c;
+    return (self->bits[byte / 64] >> (byte % 64)) & 1;
+}
+#if defined(__SSSE3__)
+/*
+    returns one bit per byte of the CHARSET_BLOCK bytes at at that is in the set
+    the low nibble picks a row of .lo or .hi (by the top bit of the byte) and the high nibble picks the bit in that row
+    NOTE: you usually won't have to call this yourself
+*/
+uint32_t charset_block_mask(const charset* self, const char* at) {
+#if defined(__AVX2__)
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    const __m256i row_bits = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+    );
+    __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)self->lo));
+    __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)self->hi));
+    __m256i block = _mm256_loadu_si256((const __m256i*)at);
+    __m256i low = _mm256_and_si256(block, low_nibbles);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibbles);
+    __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, low), _mm256_shuffle_epi8(hi, low), block);
+    __m256i bit = _mm256_shuffle_epi8(row_bits, high);
+    __m256i hits = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+    return (uint32_t)_mm256_movemask_epi8(hits);
+#else
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+    const __m128i row_bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    __m128i lo = _mm_loadu_si128((const __m128i*)self->lo);
+    __m128i hi = _mm_loadu_si128((const __m128i*)self->hi);
+    __m128i block = _mm_loadu_si128((const __m128i*)at);
+    __m128i low = _mm_and_si128(block, low_nibbles);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(block, 4), low_nibbles);
+    // no blendv before sse4.1, so pick the row with the sign of each byte
+    __m128i upper = _mm_cmplt_epi8(block, _mm_setzero_si128());
+    __m128i row = _mm_or_si128(
+        _mm_andnot_si128(upper, _mm_shuffle_epi8(lo, low)),
+        _mm_and_si128(upper, _mm_shuffle_epi8(hi, low))
+    );
+    __m128i bit = _mm_shuffle_epi8(row_bits, high);
+    __m128i hits = _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+    return (uint32_t)_mm_movemask_epi8(hits);
+#endif
+}
+#endif
+/*
+    scans forwards for the first byte that is (member = true) or isn't (member = false) in the set
+    returns {true, index} or {false, 0} if there is none
+    NOTE: you usually want str_find_first_of or str_find_first_not_of
+*/
+tuple_bool_size_t str_scan_forward(str self, const charset* set, bool member) {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    const uint32_t all = CHARSET_BLOCK == 32 ? ~(uint32_t)0 : 0xffff;
+    for (; i + CHARSET_BLOCK <= self.len; i += CHARSET_BLOCK) {
+        uint32_t mask = charset_block_mask(set, self.ptr + i);
+        if (!member) {
+            mask ^= all;
+        }
+        if (mask) {
+            return (tuple_bool_size_t){true, i + __builtin_ctz(mask)};
+        }
+    }
+#endif
+    for (; i < self.len; i++) {
+        if (charset_contains(set, self.ptr[i]) == member) {
+            return (tuple_bool_size_t){true, i};
+        }
+    }
+    return (tuple_bool_size_t){false, 0};
+}
+/*
+    scans backwards for the last byte that is (member = true) or isn't (member = false) in the set
+    returns {true, index} or {false, 0} if there is none
+    NOTE: you usually want str_find_last_of or str_find_last_not_of
+*/
+tuple_bool_size_t str_scan_backward(str self, const charset* set, bool member) {
+    size_t end = self.len;
+#if defined(__SSSE3__)
+    const uint32_t all = CHARSET_BLOCK == 32 ? ~(uint32_t)0 : 0xffff;
+    for (; end >= CHARSET_BLOCK; end -= CHARSET_BLOCK) {
+        uint32_t mask = charset_block_mask(set, self.ptr + end - CHARSET_BLOCK);
+        if (!member) {
+            mask ^= all;
+        }
+        if (mask) {
+            return (tuple_bool_size_t){true, end - CHARSET_BLOCK + 31 - __builtin_clz(mask)};
+        }
+    }
+#endif
+    for (; end > 0; end--) {
+        if (charset_contains(set, self.ptr[end - 1]) == member) {
+            return (tuple_bool_size_t){true, end - 1};
+        }
+    }
+    return (tuple_bool_size_t){false, 0};
+}
+/*
+    if the view contains any byte of the set, returns {true, index} of the first one
+    else returns {false, 0}
+    checks 16 bytes per step with ssse3 and 32 with avx2
+*/
+tuple_bool_size_t str_find_first_of(str self, const charset* set) {
+    return str_scan_forward(self, set, true);
+}
+/* same as str_find_first_of but finds the first byte that isn't in the set */
+tuple_bool_size_t str_find_first_not_of(str self, const charset* set) {
+    return str_scan_forward(self, set, false);
+}
+/* same as str_find_first_of but finds the last byte in the set */
+tuple_bool_size_t str_find_last_of(str self, const charset* set) {
+    return str_scan_backward(self, set, true);
+}
+/* same as str_find_first_of but finds the last byte that isn't in the set */
+tuple_bool_size_t str_find_last_not_of(str self, const charset* set) {
+    return str_scan_backward(self, set, false);
+}
+/* view without the leading bytes that are in the set */
+str str_strip_left(str self, const charset* set) {
+    tuple_bool_size_t begin = str_find_first_not_of(self, set);
+    return str_slice(self, begin.one ? begin.two : self.len, self.len);
+}
+/* view without the trailing bytes that are in the set */
+str str_strip_right(str self, const charset* set) {
+    tuple_bool_size_t last = str_find_last_not_of(self, set);
+    return str_slice(self, 0, last.one ? last.two + 1 : 0);
+}
+/* view without the leading or trailing bytes that are in the set */
+str str_strip(str self, const charset* set) {
+    return str_strip_right(str_strip_left(self, set), set);
+}
+/* view without leading whitespace */
+str str_trim_left(str self) {
+    charset space = charset_whitespace();
+    return str_strip_left(self, &space);
+}
+/* view without trailing whitespace */
+str str_trim_right(str self) {
+    charset space = charset_whitespace();
+    return str_strip_right(self, &space);
+}
+/* view without leading or trailing whitespace */
+str str_trim(str self) {
+    charset space = charset_whitespace();
+    return str_strip(self, &space);
+}
+/*
+    shrinks the string to the part of it that is view, which must point into the string
+    NOTE: you usually won't have to call this yourself
+*/
+void string_keep(string *self, str view) {
+    char* data = string_data(self);
+    if (view.ptr != data && view.len > 0) {
+        memmove(data, view.ptr, view.len);
+    }
+    string_set_len(self, view.len);
+}
+/* removes leading and trailing bytes that are in the set, in place */
+void string_strip(string *self, const charset* set) {
+    string_keep(self, str_strip(string_as_str(self), set));
+}
+/* removes leading whitespace in place */
+void string_trim_left(string *self) {
+    string_keep(self, str_trim_left(string_as_str(self)));
+}
+/* removes trailing whitespace in place */
+void string_trim_right(string *self) {
+    string_keep(self, str_trim_right(string_as_str(self)));
+}
+/* removes leading and trailing whitespace in place */
+void string_trim(string *self) {
+    string_keep(self, str_trim(string_as_str(self)));
+}
+
+
+
+/* ################# MULTI PATTERN MATCHING ################# */
+
+
+
+gen_dyn_with_deps(str, str);
+// match of pattern .one starting at index .two
+struct_tuple(size_t, size_t, match);
+gen_dyn_with_deps(tuple_match, match);
+
+#define MATCHER_NONE ((uint32_t)-1)
+// pattern sets up to this size use the teddy prefilter instead of the automaton when ssse3 is available
+#define MATCHER_TEDDY_MAX 8
+// number of leading pattern bytes teddy fingerprints
+#define MATCHER_TEDDY_LEN 3
+
+// compiled set of patterns, matched in a single pass over the text
+// the patterns are copied so the views passed to matcher_init don't need to outlive it
+// .delta is the aho corasick dfa, .delta[state * 256 + byte] is the next state
+// .state_pattern is the first pattern ending at a state, .pattern_next chains the rest (duplicate patterns)
+// .dict_link is the closest suffix state that ends a pattern, 0 if there is none
+typedef struct {
+    string bytes;
+    dyn_size_t offsets;
+    size_t pattern_count;
+    uint32_t* delta;
+    uint32_t* state_pattern;
+    uint32_t* dict_link;
+    uint32_t* pattern_next;
+    size_t state_count;
+    bool teddy;
+    size_t teddy_len;
+    unsigned char teddy_lo[MATCHER_TEDDY_LEN][16];
+    unsigned char teddy_hi[MATCHER_TEDDY_LEN][16];
+} matcher;
+
+/* returns a view of pattern index */
+str matcher_pattern(matcher* self, size_t index) {
+    size_t begin = self->offsets.buf[index];
+    return str_from_bytes(string_cstr(&self->bytes) + begin, self->offsets.buf[index + 1] - begin);
+}
+/*
+    builds the aho corasick dfa, every missing transition is filled in from the failure links
+    NOTE: you usually won't have to call this yourself
+*/
+void matcher_build_dfa(matcher* self) {
+    size_t max_states = string_len(&self->bytes) + 1;
+    uint32_t* delta = (uint32_t*)calloc(max_states * 256, sizeof(uint32_t));
+    uint32_t* state_pattern = (uint32_t*)malloc(sizeof(uint32_t) * max_states);
+    uint32_t* dict_link = (uint32_t*)calloc(max_states, sizeof(uint32_t));
+    uint32_t* fail = (uint32_t*)calloc(max_states, sizeof(uint32_t));
+    uint32_t* queue = (uint32_t*)malloc(sizeof(uint32_t) * max_states);
+    self->pattern_next = (uint32_t*)malloc(sizeof(uint32_t) * (self->pattern_count ? self->pattern_count : 1));
+    for (size_t s = 0; s < max_states; s++) {
+        state_pattern[s] = MATCHER_NONE;
+    }
+
+    // trie, 0 doubles as "no child" since nothing transitions back into the root while building
+    size_t state_count = 1;
+    for (size_t p = self->pattern_count; p-- > 0;) {
+        str pattern = matcher_pattern(self, p);
+        self->pattern_next[p] = MATCHER_NONE;
+        if (pattern.len == 0) {
+            continue;
+        }
+        uint32_t state = 0;
+        for (size_t i = 0; i < pattern.len; i++) {
+            uint32_t* next = &delta[state * 256 + (unsigned char)pattern.ptr[i]];
+            if (*next == 0) {
+                *next = (uint32_t)state_count++;
+            }
+            state = *next;
+        }
+        // walking backwards keeps each chain in ascending pattern order
+        self->pattern_next[p] = state_pattern[state];
+        state_pattern[state] = (uint32_t)p;
+    }
+
+    // breadth first so every failure link is finished before its state is used
+    size_t head = 0;
+    size_t tail = 0;
+    for (size_t c = 0; c < 256; c++) {
+        if (delta[c]) {
+            queue[tail++] = delta[c];
+        }
+    }
+    while (head < tail) {
+        uint32_t state = queue[head++];
+        for (size_t c = 0; c < 256; c++) {
+            uint32_t* next = &delta[state * 256 + c];
+            uint32_t fallback = delta[fail[state] * 256 + c];
+            if (*next == 0) {
+                *next = fallback;
+                continue;
+            }
+            fail[*next] = fallback;
+            dict_link[*next] = state_pattern[fallback] != MATCHER_NONE ? fallback : dict_link[fallback];
+            queue[tail++] = *next;
+        }
+    }
+
+    free(fail);
+    free(queue);
+    self->delta = delta;
+    self->state_pattern = state_pattern;
+    self->dict_link = dict_link;
+    self->state_count = state_count;
+}
+#if defined(__SSSE3__)
+/*
+    fills the teddy nibble tables, every pattern gets its own bucket bit
+    NOTE: you usually won't have to call this yourself
+*/
+void matcher_build_teddy(matcher* self) {
+    memset(self->teddy_lo, 0, sizeof(self->teddy_lo));
+    memset(self->teddy_hi, 0, sizeof(self->teddy_hi));
+    size_t teddy_len = MATCHER_TEDDY_LEN;
+    for (size_t p = 0; p < self->pattern_count; p++) {
+        size_t len = matcher_pattern(self, p).len;
+        if (len < teddy_len) {
+            teddy_len = len;
+        }
+    }
+    self->teddy_len = teddy_len;
+    for (size_t p = 0; p < self->pattern_count; p++) {
+        str pattern = matcher_pattern(self, p);
+        for (size_t k = 0; k < teddy_len; k++) {
+            unsigned char c = (unsigned char)pattern.ptr[k];
+            self->teddy_lo[k][c & 15] |= (unsigned char)(1 << p);
+            self->teddy_hi[k][c >> 4] |= (unsigned char)(1 << p);
+        }
+    }
+}
+#endif
+/*
+    compiles patterns into a matcher
+    small sets (up to MATCHER_TEDDY_MAX non empty patterns) use the teddy simd prefilter when built with ssse3,
+    everything else goes through the aho corasick dfa
+    empty patterns never match
+
+    NOTE: call matcher_deinit to free
+*/
+matcher matcher_init(dyn_str* patterns) {
+    matcher self = {
+        .bytes = string_init(),
+        .offsets = dyn_init_with_cap_size_t(patterns->len + 1),
+        .pattern_count = patterns->len,
+    };
+    size_t total = 0;
+    size_t empty = 0;
+    for (size_t p = 0; p < patterns->len; p++) {
+        total += patterns->buf[p].len;
+        empty += patterns->buf[p].len == 0;
+    }
+    string_reserve(&self.bytes, total);
+    dyn_push_size_t(&self.offsets, 0);
+    for (size_t p = 0; p < patterns->len; p++) {
+        string_push_str(&self.bytes, patterns->buf[p]);
+        dyn_push_size_t(&self.offsets, string_len(&self.bytes));
+    }
+
+    bool small = empty == 0 && patterns->len > 0 && patterns->len <= MATCHER_TEDDY_MAX;
+#if defined(__SSSE3__)
+    if (small) {
+        self.teddy = true;
+        matcher_build_teddy(&self);
+    }
+#else
+    (void)small;
+#endif
+    if (!self.teddy) {
+        matcher_build_dfa(&self);
+    }
+    return self;
+}
+int matcher_compare_match(const void* one, const void* two) {
+    const tuple_match* a = (const tuple_match*)one;
+    const tuple_match* b = (const tuple_match*)two;
+    if (a->two != b->two) {
+        return a->two < b->two ? -1 : 1;
+    }
+    return (a->one > b->one) - (a->one < b->one);
+}
+/*
+    runs the dfa over text, pushing every match onto found if it isn't NULL
+    stops at the first match when found is NULL
+    returns true if anything matched
+    NOTE: you usually won't have to call this yourself
+*/
+bool matcher_scan_dfa(matcher* self, str text, dyn_match* found) {
+    const unsigned char* bytes = (const unsigned char*)text.ptr;
+    uint32_t state = 0;
+    bool any = false;
+    for (size_t i = 0; i < text.len; i++) {
+        state = self->delta[state * 256 + bytes[i]];
+        if (self->state_pattern[state] == MATCHER_NONE && self->dict_link[state] == 0) {
+            continue;
+        }
+        if (!found) {
+            return true;
+        }
+        any = true;
+        for (uint32_t s = state; s != 0; s = self->dict_link[s]) {
+            for (uint32_t p = self->state_pattern[s]; p != MATCHER_NONE; p = self->pattern_next[p]) {
+                size_t len = self->offsets.buf[p + 1] - self->offsets.buf[p];
+                dyn_push_match(found, (tuple_match){p, i + 1 - len});
+            }
+        }
+    }
+    return any;
+}
+#if defined(__SSSE3__)
+/*
+    checks the buckets flagged at text position at, pushing full matches onto found if it isn't NULL
+    NOTE: you usually won't have to call this yourself
+*/
+bool matcher_teddy_verify(matcher* self, str text, size_t at, unsigned buckets, dyn_match* found) {
+    bool any = false;
+    while (buckets) {
+        size_t p = __builtin_ctz(buckets);
+        buckets &= buckets - 1;
+        str pattern = matcher_pattern(self, p);
+        if (at + pattern.len <= text.len && memcmp(text.ptr + at, pattern.ptr, pattern.len) == 0) {
+            if (!found) {
+                return true;
+            }
+            any = true;
+            dyn_push_match(found, (tuple_match){p, at});
+        }
+    }
+    return any;
+}
+/*
+    teddy: looks up the low and high nibble of the first teddy_len bytes at every position with pshufb,
+    the and of those lookups leaves a bit for every pattern whose fingerprint matches there
+    NOTE: you usually won't have to call this yourself
+*/
+bool matcher_scan_teddy(matcher* self, str text, dyn_match* found) {
+    size_t len = self->teddy_len;
+    size_t i = 0;
+    bool any = false;
+#if defined(__AVX2__)
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    __m256i lo[MATCHER_TEDDY_LEN];
+    __m256i hi[MATCHER_TEDDY_LEN];
+    for (size_t k = 0; k < len; k++) {
+        lo[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)self->teddy_lo[k]));
+        hi[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)self->teddy_hi[k]));
+    }
+    for (; i + 32 + len - 1 <= text.len; i += 32) {
+        __m256i buckets = _mm256_set1_epi8((char)0xff);
+        for (size_t k = 0; k < len; k++) {
+            __m256i block = _mm256_loadu_si256((const __m256i*)(text.ptr + i + k));
+            __m256i lo_bits = _mm256_shuffle_epi8(lo[k], _mm256_and_si256(block, low_nibbles));
+            __m256i hi_bits = _mm256_shuffle_epi8(hi[k], _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibbles));
+            buckets = _mm256_and_si256(buckets, _mm256_and_si256(lo_bits, hi_bits));
+        }
+        uint32_t candidates = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, _mm256_setzero_si256()));
+        if (!candidates) {
+            continue;
+        }
+        unsigned char lanes[32];
+        _mm256_storeu_si256((__m256i*)lanes, buckets);
+        while (candidates) {
+            size_t j = __builtin_ctz(candidates);
+            candidates &= candidates - 1;
+            if (matcher_teddy_verify(self, text, i + j, lanes[j], found)) {
+                if (!found) {
+                    return true;
+                }
+                any = true;
+            }
+        }
+    }
+#else
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+    __m128i lo[MATCHER_TEDDY_LEN];
+    __m128i hi[MATCHER_TEDDY_LEN];
+    for (size_t k = 0; k < len; k++) {
+        lo[k] = _mm_loadu_si128((const __m128i*)self->teddy_lo[k]);
+        hi[k] = _mm_loadu_si128((const __m128i*)self->teddy_hi[k]);
+    }
+    for (; i + 16 + len - 1 <= text.len; i += 16) {
+        __m128i buckets = _mm_set1_epi8((char)0xff);
+        for (size_t k = 0; k < len; k++) {
+            __m128i block = _mm_loadu_si128((const __m128i*)(text.ptr + i + k));
+            __m128i lo_bits = _mm_shuffle_epi8(lo[k], _mm_and_si128(block, low_nibbles));
+            __m128i hi_bits = _mm_shuffle_epi8(hi[k], _mm_and_si128(_mm_srli_epi16(block, 4), low_nibbles));
+            buckets = _mm_and_si128(buckets, _mm_and_si128(lo_bits, hi_bits));
+        }
+        uint32_t candidates = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, _mm_setzero_si128())) & 0xffff;
+        if (!candidates) {
+            continue;
+        }
+        unsigned char lanes[16];
+        _mm_storeu_si128((__m128i*)lanes, buckets);
+        while (candidates) {
+            size_t j = __builtin_ctz(candidates);
+            candidates &= candidates - 1;
+            if (matcher_teddy_verify(self, text, i + j, lanes[j], found)) {
+                if (!found) {
+                    return true;
+                }
+                any = true;
+            }
+        }
+    }
+#endif
+    // same lookups one position at a time for the tail
+    for (; i + len <= text.len; i++) {
+        unsigned buckets = 0xff;
+        for (size_t k = 0; k < len; k++) {
+            unsigned char c = (unsigned char)text.ptr[i + k];
+            buckets &= self->teddy_lo[k][c & 15] & self->teddy_hi[k][c >> 4];
+        }
+        if (buckets && matcher_teddy_verify(self, text, i, buckets, found)) {
+            if (!found) {
+                return true;
+            }
+            any = true;
+        }
+    }
+    return any;
+}
+#endif
+/* returns true if any pattern occurs in text, stops at the first match */
+bool matcher_contains(matcher* self, str text) {
+#if defined(__SSSE3__)
+    if (self->teddy) {
+        return matcher_scan_teddy(self, text, NULL);
+    }
+#endif
+    return matcher_scan_dfa(self, text, NULL);
+}
+/*
+    finds every occurrence of every pattern in a single pass over text, including overlapping ones
+    matches are ordered by start, then by pattern index
+
+    NOTE: call dyn_deinit_match to free
+*/
+dyn_match matcher_find_all(matcher* self, str text) {
+    dyn_match found = dyn_init_match();
+#if defined(__SSSE3__)
+    if (self->teddy) {
+        matcher_scan_teddy(self, text, &found);
+        return found;
+    }
+#endif
+    // the dfa reports matches as they end
+    matcher_scan_dfa(self, text, &found);
+    qsort(found.buf, found.len, sizeof(tuple_match), matcher_compare_match);
+    return found;
+}
+/* same as matcher_find_all over the whole string */
+dyn_match matcher_find_all_string(matcher* self, const string* text) {
+    return matcher_find_all(self, string_as_str(text));
+}
+void matcher_deinit(matcher* self) {
+    string_deinit(&self->bytes);
+    dyn_deinit_size_t(&self->offsets);
+    if (!self->teddy) {
+        free(self->delta);
+        free(self->state_pattern);
+        free(self->dict_link);
+        free(self->pattern_next);
+    }
+    self->pattern_count = 0;
+}
+
+// replaces many patterns at once, pattern i of the matcher is replaced by replacement i
+typedef struct {
+    matcher patterns;
+    string replacements;
+    dyn_size_t offsets;
+} replacer;
+
+/*
+    compiles the from patterns into a matcher and copies the replacements
+    from->buf[i] becomes to->buf[i], patterns without a replacement (to is shorter than from) are deleted
+
+    NOTE: call replacer_deinit to free
+*/
+replacer replacer_init(dyn_str* from, dyn_str* to) {
+    replacer self = {
+        .patterns = matcher_init(from),
+        .replacements = string_init(),
+        .offsets = dyn_init_with_cap_size_t(from->len + 1),
+    };
+    dyn_push_size_t(&self.offsets, 0);
+    for (size_t i = 0; i < from->len; i++) {
+        if (i < to->len) {
+            string_push_str(&self.replacements, to->buf[i]);
+        }
+        dyn_push_size_t(&self.offsets, string_len(&self.replacements));
+    }
+    return self;
+}
+/* returns a view of the replacement for pattern index */
+str replacer_replacement(replacer* self, size_t index) {
+    size_t begin = self->offsets.buf[index];
+    return str_from_bytes(string_cstr(&self->replacements) + begin, self->offsets.buf[index + 1] - begin);
+}
+/*
+    copy of text with every pattern replaced in a single pass of the matcher
+    where matches overlap the leftmost wins, and of those starting at the same place the longest,
+    replaced text is never searched again so "a" -> "aa" doesn't loop
+    the matches are collected first so the result is allocated once at its exact size
+
+    NOTE: call string_deinit to free
+*/
+string replacer_apply(replacer* self, str text) {
+    dyn_match found = matcher_find_all(&self->patterns, text);
+    // keep the leftmost longest non overlapping matches, compacted to the front of found
+    size_t kept = 0;
+    size_t end = 0;
+    size_t len = text.len;
+    for (size_t i = 0; i < found.len;) {
+        size_t start = found.buf[i].two;
+        size_t best = found.buf[i].one;
+        size_t j = i + 1;
+        for (; j < found.len && found.buf[j].two == start; j++) {
+            if (matcher_pattern(&self->patterns, found.buf[j].one).len > matcher_pattern(&self->patterns, best).len) {
+                best = found.buf[j].one;
+            }
+        }
+        i = j;
+        if (start < end) {
+            continue;
+        }
+        str pattern = matcher_pattern(&self->patterns, best);
+        end = start + pattern.len;
+        len = len - pattern.len + replacer_replacement(self, best).len;
+        found.buf[kept++] = (tuple_match){best, start};
+    }
+
+    string result = string_init();
+    string_reserve(&result, len);
+    char* out = string_data(&result);
+    size_t at = 0;
+    for (size_t i = 0; i < kept; i++) {
+        size_t start = found.buf[i].two;
+        str replacement = replacer_replacement(self, found.buf[i].one);
+        memcpy(out, text.ptr + at, start - at);
+        out += start - at;
+        if (replacement.len) {
+            memcpy(out, replacement.ptr, replacement.len);
+        }
+        out += replacement.len;
+        at = start + matcher_pattern(&self->patterns, found.buf[i].one).len;
+    }
+    if (text.len > at) {
+        memcpy(out, text.ptr + at, text.len - at);
+    }
+    string_set_len(&result, len);
+    dyn_deinit_match(&found);
+    return result;
+}
+/* same as replacer_apply over the whole string, the string is swapped for the result */
+void replacer_apply_string(replacer* self, string* text) {
+    string result = replacer_apply(self, string_as_str(text));
+    string_deinit(text);
+    *text = result;
+}
+void replacer_deinit(replacer* self) {
+    matcher_deinit(&self->patterns);
+    string_deinit(&self->replacements);
+    dyn_deinit_size_t(&self->offsets);
+}
+
+
+
+/* ################# SPLIT ITERATORS ################# */
+
+
+
+// what a splitter splits on
+typedef enum {
+    SPLIT_CHAR,
+    SPLIT_ANY,
+    SPLIT_LINES,
+    SPLIT_WORDS,
+} split_kind;
+
+// most delimiters string_split_any compares against with simd, more than this falls back to a byte table
+#define SPLIT_SIMD_DELIMS 8
+#if defined(__AVX2__)
+#define SPLIT_BLOCK 32
+#else
+#define SPLIT_BLOCK 16
+#endif
+
+// zero copy iterator over the pieces of a view, call splitter_next until it returns .ok = false
+// .block/.mask cache the delimiter positions of the last block scanned so nearby pieces don't rescan it
+typedef struct {
+    str rest;
+    split_kind kind;
+    bool done;
+    char delims[SPLIT_SIMD_DELIMS];
+    size_t delim_count;
+    uint64_t table[4];
+    const char* block;
+    uint32_t mask;
+} splitter;
+
+/*
+    sets up a splitter over the bytes in delims
+    NOTE: you usually want string_split, string_split_any, string_lines or string_words
+*/
+splitter splitter_init(str self, split_kind kind, str delims) {
+    splitter it = {.rest = self, .kind = kind, .done = false, .delim_count = delims.len, .block = NULL};
+    memset(it.table, 0, sizeof(it.table));
+    for (size_t i = 0; i < delims.len; i++) {
+        unsigned char c = (unsigned char)delims.ptr[i];
+        it.table[c / 64] |= (uint64_t)1 << (c % 64);
+        if (i < SPLIT_SIMD_DELIMS) {
+            it.delims[i] = delims.ptr[i];
+        }
+    }
+    return it;
+}
+/*
+    iterator over the pieces between each delim, empty pieces included
+    "a,,b" gives "a", "", "b" and an empty view gives a single empty piece
+*/
+splitter string_split(str self, char delim) {
+    return splitter_init(self, SPLIT_CHAR, str_from_bytes(&delim, 1));
+}
+/* same as string_split but any byte in delims ends a piece */
+splitter string_split_any(str self, str delims) {
+    return splitter_init(self, SPLIT_ANY, delims);
+}
+/* iterator over lines ending in \n or \r\n, a trailing newline doesn't add an empty last line */
+splitter string_lines(str self) {
+    return splitter_init(self, SPLIT_LINES, str_from_cstr("\n"));
+}
+/* iterator over runs of non whitespace, never yields empty pieces */
+splitter string_words(str self) {
+    return splitter_init(self, SPLIT_WORDS, str_from_cstr(" \t\n\r\v\f"));
+}
+/* returns true if c is one of the splitter's delimiters */
+bool splitter_is_delim(splitter* self, char c) {
+    unsigned char byte = (unsigned char)c;
+    return (self->table[byte / 64] >> (byte % 64)) & 1;
+}
+#if defined(__AVX2__) || defined(__SSE2__)
+/*
+    compares SPLIT_BLOCK bytes at once against every delimiter and returns one bit per matching byte
+    NOTE: you usually won't have to call this yourself
+*/
+uint32_t splitter_block_mask(splitter* self, const char* at) {
+#if defined(__AVX2__)
+    __m256i block = _mm256_loadu_si256((const __m256i*)at);
+    __m256i hits = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(self->delims[0]));
+    for (size_t i = 1; i < self->delim_count; i++) {
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(self->delims[i])));
+    }
+    return (uint32_t)_mm256_movemask_epi8(hits);
+#else
+    __m128i block = _mm_loadu_si128((const __m128i*)at);
+    __m128i hits = _mm_cmpeq_epi8(block, _mm_set1_epi8(self->delims[0]));
+    for (size_t i = 1; i < self->delim_count; i++) {
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(self->delims[i])));
+    }
+    return (uint32_t)_mm_movemask_epi8(hits);
+#endif
+}
+#endif
+/*
+    finds the next delimiter in .rest, reusing the cached block mask when .rest still starts inside it
+    returns NULL if there is none
+    NOTE: you usually won't have to call this yourself
+*/
+const char* splitter_find(splitter* self) {
+    const char* at = self->rest.ptr;
+    const char* end = self->rest.ptr + self->rest.len;
+#if defined(__AVX2__) || defined(__SSE2__)
+    if (self->delim_count > 0 && self->delim_count <= SPLIT_SIMD_DELIMS) {
+        if (self->block && at >= self->block && at < self->block + SPLIT_BLOCK) {
+            uint32_t mask = self->mask & (~(uint32_t)0 << (at - self->block));
+            if (mask) {
+                return self->block + __builtin_ctz(mask);
+            }
+            at = self->block + SPLIT_BLOCK;
+        }
+        for (; at + SPLIT_BLOCK <= end; at += SPLIT_BLOCK) {
+            uint32_t mask = splitter_block_mask(self, at);
+            if (mask) {
+                self->block = at;
+                self->mask = mask;
+                return at + __builtin_ctz(mask);
+            }
+        }
+    }
+#endif
+    for (; at < end; at++) {
+        if (splitter_is_delim(self, *at)) {
+            return at;
+        }
+    }
+    return NULL;
+}
+/*
+    returns the next piece as an option
+    once every piece has been returned, returns .ok = false
+*/
+option_str splitter_next(splitter* self) {
+    if (self->kind == SPLIT_WORDS) {
+        while (self->rest.len && splitter_is_delim(self, self->rest.ptr[0])) {
+            self->rest = str_slice(self->rest, 1, self->rest.len);
+        }
+        if (self->rest.len == 0) {
+            self->done = true;
+        }
+    }
+    if (self->kind == SPLIT_LINES && self->rest.len == 0) {
+        self->done = true;
+    }
+    if (self->done) {
+        return (option_str){.ok = false};
+    }
+
+    const char* found = splitter_find(self);
+    str piece;
+    if (found) {
+        piece = str_from_bytes(self->rest.ptr, found - self->rest.ptr);
+        self->rest = str_slice(self->rest, piece.len + 1, self->rest.len);
+    } else {
+        piece = self->rest;
+        self->rest = str_slice(self->rest, self->rest.len, self->rest.len);
+        self->done = true;
+    }
+    if (self->kind == SPLIT_LINES && piece.len && piece.ptr[piece.len - 1] == '\r') {
+        piece.len -= 1;
+    }
+    return (option_str){.ok = true, .value = piece};
+}
+
+// little macro to loop over the pieces of a splitter
+// to use: split_each(field, string_split(line, ','), { ... })
+#define split_each(piece, iterator, codeblock)\
+for (splitter piece##_splitter = iterator;;) {\
+    option_str piece##_next = splitter_next(&piece##_splitter);\
+    if (!piece##_next.ok) {\
+        break;\
+    }\
+    str piece = piece##_next.value;\
+    codeblock\
+}
+
+
+
+/* ################# UTF-8 ################# */
+
+
+
+gen_dyn_with_deps(uint32_t, u32);
+struct_result(dyn_u32, dyn_u32);
+
+// code point yielded for invalid bytes by the iterator
+#define UTF8_REPLACEMENT 0xfffd
+
+/*
+    decodes one code point at bytes, rejecting overlong forms, surrogates and anything past U+10FFFF
+    returns the number of bytes used or 0 if the sequence is invalid or cut off
+*/
+size_t utf8_decode(const char* bytes, size_t len, uint32_t* codepoint) {
+    const unsigned char* s = (const unsigned char*)bytes;
+    if (len == 0) {
+        return 0;
+    }
+    unsigned char c = s[0];
+    if (c < 0x80) {
+        *codepoint = c;
+        return 1;
+    }
+    size_t need;
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+        need = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        need = 3;
+        if (c == 0xe0) {
+            low = 0xa0;
+        } else if (c == 0xed) {
+            high = 0x9f;
+        }
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        need = 4;
+        if (c == 0xf0) {
+            low = 0x90;
+        } else if (c == 0xf4) {
+            high = 0x8f;
+        }
+    } else {
+        return 0;
+    }
+    if (len < need || s[1] < low || s[1] > high) {
+        return 0;
+    }
+    uint32_t value = c & (0x7f >> need);
+    for (size_t i = 1; i < need; i++) {
+        if (i > 1 && (s[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        value = (value << 6) | (s[i] & 0x3f);
+    }
+    *codepoint = value;
+    return need;
+}
+/*
+    scalar validation, skips 8 ascii bytes at a time
+    NOTE: you usually want utf8_valid
+*/
+bool utf8_valid_scalar(const char* bytes, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        if (i + 8 <= len) {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(word));
+            if (!(word & 0x8080808080808080ull)) {
+                i += 8;
+                continue;
+            }
+        }
+        uint32_t codepoint;
+        size_t used = utf8_decode(bytes + i, len - i, &codepoint);
+        if (used == 0) {
+            return false;
+        }
+        i += used;
+    }
+    return true;
+}
+#if defined(__AVX2__)
+/*
+    the 32 bytes of input shifted back by n with the end of previous shifted in, i.e. the byte n positions earlier
+    NOTE: you usually won't have to call this yourself
+*/
+#define utf8_prev(input, previous, n) _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - (n))
+
+// error bits for each pair of (previous byte, current byte), "validating utf-8 in less than one instruction per byte" by keiser and lemire
+#define UTF8_TOO_SHORT (1 << 0)
+#define UTF8_TOO_LONG (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE (1 << 3)
+#define UTF8_SURROGATE (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/*
+    looks up the high and low nibble of the previous byte and the high nibble of the current one,
+    a bit that survives all three lookups is an error
+    NOTE: you usually won't have to call this yourself
+*/
+__m256i utf8_special_cases(__m256i input, __m256i prev1) {
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    const __m256i byte_1_high_table = _mm256_setr_epi8(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+    );
+    const __m256i byte_1_low_table = _mm256_setr_epi8(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+    );
+    const __m256i byte_2_high_table = _mm256_setr_epi8(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+    );
+    __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibbles));
+    __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, low_nibbles));
+    __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibbles));
+    return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+}
+/*
+    checks one block of 32 bytes, carrying sequences that straddle blocks through previous/incomplete
+    NOTE: you usually won't have to call this yourself
+*/
+__m256i utf8_check_block(__m256i input, __m256i* previous, __m256i* incomplete) {
+    __m256i error;
+    if (_mm256_movemask_epi8(input) == 0) {
+        // all ascii, only a sequence left open by the last block can be wrong
+        error = *incomplete;
+        *incomplete = _mm256_setzero_si256();
+    } else {
+        __m256i prev1 = utf8_prev(input, *previous, 1);
+        __m256i special = utf8_special_cases(input, prev1);
+        // bytes two or three after a 3 or 4 byte lead must be continuations, which the lookups mark as TWO_CONTS
+        __m256i prev2 = utf8_prev(input, *previous, 2);
+        __m256i prev3 = utf8_prev(input, *previous, 3);
+        __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80)));
+        __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80)));
+        __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+        error = _mm256_xor_si256(must_continue, special);
+        // a lead byte in the last 3 positions needs bytes from the next block
+        const __m256i max_complete = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            (char)(0xf0 - 1), (char)(0xe0 - 1), (char)(0xc0 - 1)
+        );
+        *incomplete = _mm256_subs_epu8(input, max_complete);
+    }
+    *previous = input;
+    return error;
+}
+#endif
+/*
+    returns true if bytes is valid utf-8
+    with avx2 this checks 32 bytes per step using nibble lookup tables instead of branching on every byte
+*/
+bool utf8_valid(const char* bytes, size_t len) {
+#if defined(__AVX2__)
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i*)(bytes + i));
+        error = _mm256_or_si256(error, utf8_check_block(input, &previous, &incomplete));
+    }
+    if (i < len) {
+        // zero padding is ascii, so a sequence cut off by the end shows up as too short
+        char tail[32] = {0};
+        memcpy(tail, bytes + i, len - i);
+        __m256i input = _mm256_loadu_si256((const __m256i*)tail);
+        error = _mm256_or_si256(error, utf8_check_block(input, &previous, &incomplete));
+    }
+    error = _mm256_or_si256(error, incomplete);
+    return _mm256_testz_si256(error, error);
+#else
+    return utf8_valid_scalar(bytes, len);
+#endif
+}
+bool str_utf8_valid(str self) {
+    return utf8_valid(self.ptr, self.len);
+}
+bool string_utf8_valid(const string *self) {
+    return utf8_valid(string_cstr(self), string_len(self));
+}
+/*
+    returns the number of code points, counting every byte that isn't a continuation byte
+    NOTE: assumes valid utf-8, check with str_utf8_valid first if you need to
+*/
+size_t str_utf8_count(str self) {
+    size_t count = 0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    // continuation bytes are 0x80..0xbf, which as signed bytes are exactly the ones <= -65
+    const __m256i last_continuation = _mm256_set1_epi8((char)0xbf);
+    for (; i + 32 <= self.len; i += 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i*)(self.ptr + i));
+        count += __builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(input, last_continuation)));
+    }
+#endif
+    for (; i < self.len; i++) {
+        count += ((unsigned char)self.ptr[i] & 0xc0) != 0x80;
+    }
+    return count;
+}
+size_t string_utf8_count(const string *self) {
+    return str_utf8_count(string_as_str(self));
+}
+/*
+    decodes the whole view into utf-32 code points, runs of ascii are widened 8 bytes at a time with avx2
+    returns ERR_INVALID_FORMAT if the view isn't valid utf-8
+
+    NOTE: call dyn_deinit_u32 to free
+*/
+result_dyn_u32 str_to_utf32(str self) {
+    dyn_u32 out = dyn_init_with_cap_u32(self.len + 1);
+    size_t i = 0;
+    while (i < self.len) {
+#if defined(__AVX2__)
+        if (i + 8 <= self.len) {
+            uint64_t word;
+            memcpy(&word, self.ptr + i, sizeof(word));
+            if (!(word & 0x8080808080808080ull)) {
+                __m256i wide = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(self.ptr + i)));
+                _mm256_storeu_si256((__m256i*)(out.buf + out.len), wide);
+                out.len += 8;
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        uint32_t codepoint;
+        size_t used = utf8_decode(self.ptr + i, self.len - i, &codepoint);
+        if (used == 0) {
+            dyn_deinit_u32(&out);
+            return (result_dyn_u32){.err = ERR_INVALID_FORMAT};
+        }
+        out.buf[out.len++] = codepoint;
+        i += used;
+    }
+    return (result_dyn_u32){.err = ERR_NONE, .value = out};
+}
+result_dyn_u32 string_to_utf32(const string *self) {
+    return str_to_utf32(string_as_str(self));
+}
+
+// iterator over the code points of a view, call utf8_next until it returns .ok = false
+typedef struct {
+    str rest;
+} utf8_iter;
+
+/* iterator over the code points of the view */
+utf8_iter str_codepoints(str self) {
+    return (utf8_iter){.rest = self};
+}
+/* iterator over the code points of the string */
+utf8_iter string_codepoints(const string *self) {
+    return (utf8_iter){.rest = string_as_str(self)};
+}
+/*
+    returns the next code point as an option
+    an invalid byte comes out as UTF8_REPLACEMENT and only that byte is skipped
+    once the view is used up, returns .ok = false
+*/
+option_u32 utf8_next(utf8_iter* self) {
+    if (self->rest.len == 0) {
+        return (option_u32){.ok = false};
+    }
+    uint32_t codepoint;
+    size_t used = utf8_decode(self->rest.ptr, self->rest.len, &codepoint);
+    if (used == 0) {
+        codepoint = UTF8_REPLACEMENT;
+        used = 1;
+    }
+    self->rest = str_slice(self->rest, used, self->rest.len);
+    return (option_u32){.ok = true, .value = codepoint};
+}
+
+
+
+/* ################# STRING BUILDER ################# */
+
+
+
+// size of each block a builder appends into
+#define BUILDER_BLOCK_SIZE 65536
+// most iovecs handed to a single writev call
+#ifdef IOV_MAX
+#define BUILDER_IOV_MAX IOV_MAX
+#else
+#define BUILDER_IOV_MAX 1024
+#endif
+
+gen_dyn_with_deps(dyn_char, builder_block);
+
+// appends into a list of fixed size blocks so nothing already written is ever copied again
+// flatten once at the end with builder_build or write the blocks straight out with builder_write
+typedef struct {
+    dyn_builder_block blocks;
+    size_t len;
+} builder;
+
+/*
+    initialise an empty builder, the first block is allocated on the first push
+
+    NOTE: call builder_deinit to free
+*/
+builder builder_init() {
+    return (builder){.blocks = dyn_init_with_cap_builder_block(8), .len = 0};
+}
+/* returns the total number of chars pushed so far */
+size_t builder_len(builder *self) {
+    return self->len;
+}
+/*
+    pushes len bytes, fills the last block and starts new ones as needed
+    a push bigger than BUILDER_BLOCK_SIZE gets a block of its own size
+*/
+void builder_push_bytes(builder *self, const char* content, size_t len) {
+    self->len += len;
+    if (self->blocks.len) {
+        dyn_char* last = &self->blocks.buf[self->blocks.len - 1];
+        size_t room = last->cap - last->len;
+        size_t take = len < room ? len : room;
+        memcpy(last->buf + last->len, content, take);
+        last->len += take;
+        content += take;
+        len -= take;
+    }
+    if (len == 0) {
+        return;
+    }
+    dyn_char block = dyn_init_with_cap_char(len > BUILDER_BLOCK_SIZE ? len : BUILDER_BLOCK_SIZE);
+    memcpy(block.buf, content, len);
+    block.len = len;
+    dyn_push_builder_block(&self->blocks, block);
+}
+void builder_push_char(builder *self, char elem) {
+    builder_push_bytes(self, &elem, 1);
+}
+/* pushes a c string that needs to be null terminated, the terminator isn't pushed */
+void builder_push_cstr(builder *self, const char* content) {
+    builder_push_bytes(self, content, strlen(content));
+}
+void builder_push_str(builder *self, str content) {
+    builder_push_bytes(self, content.ptr, content.len);
+}
+void builder_push_string(builder *self, const string *content) {
+    builder_push_bytes(self, string_cstr(content), string_len(content));
+}
+/*
+    flattens the blocks into a single string, allocating exactly once
+
+    NOTE: call string_deinit to free, the builder still needs builder_deinit
+*/
+string builder_build(builder *self) {
+    string result = string_init();
+    string_reserve(&result, self->len);
+    char* data = string_data(&result);
+    size_t at = 0;
+    for (size_t i = 0; i < self->blocks.len; i++) {
+        memcpy(data + at, self->blocks.buf[i].buf, self->blocks.buf[i].len);
+        at += self->blocks.buf[i].len;
+    }
+    string_set_len(&result, at);
+    return result;
+}
+/*
+    writes every block to fd with writev, retrying partial and interrupted writes, without flattening first
+    returns the number of bytes written or ERR_IO with the bytes written so far if a write fails or stops making progress
+*/
+result_size_t builder_write(builder *self, int fd) {
+    struct iovec iov[BUILDER_IOV_MAX];
+    size_t written = 0;
+    size_t block = 0;
+    size_t offset = 0;
+    while (block < self->blocks.len) {
+        int count = 0;
+        size_t pending = 0;
+        for (size_t i = block; i < self->blocks.len && count < BUILDER_IOV_MAX; i++) {
+            size_t skip = i == block ? offset : 0;
+            iov[count].iov_base = self->blocks.buf[i].buf + skip;
+            iov[count].iov_len = self->blocks.buf[i].len - skip;
+            pending += iov[count].iov_len;
+            count += 1;
+        }
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        // nothing written while bytes are left would loop forever
+        if (n < 0 || (n == 0 && pending > 0)) {
+            return (result_size_t){.err = ERR_IO, .value = written};
+        }
+        written += (size_t)n;
+        // walk forward past whatever made it out
+        size_t left = (size_t)n;
+        while (block < self->blocks.len && left >= self->blocks.buf[block].len - offset) {
+            left -= self->blocks.buf[block].len - offset;
+            block += 1;
+            offset = 0;
+        }
+        offset += left;
+    }
+    return (result_size_t){.err = ERR_NONE, .value = written};
+}
+void builder_clear(builder *self) {
+    for (size_t i = 0; i < self->blocks.len; i++) {
+        dyn_deinit_char(&self->blocks.buf[i]);
+    }
+    dyn_clear_builder_block(&self->blocks);
+    self->len = 0;
+}
+void builder_deinit(builder *self) {
+    builder_clear(self);
+    dyn_deinit_builder_block(&self->blocks);
+}
+
+
+
+/* ################# ROPE ################# */
+
+
+
+// max chars stored in a single rope node
+#define ROPE_CHUNK 512
+
+// node of an implicit treap, the in order walk of the chunks spells out the text
+// .size is the number of chars in the whole subtree, used to find positions
+typedef struct rope_node {
+    struct rope_node* left;
+    struct rope_node* right;
+    size_t size;
+    size_t len;
+    uint64_t priority;
+    char chunk[ROPE_CHUNK];
+} rope_node;
+
+// balanced rope for editing large text in the middle
+// insert and remove are O(log n) expected plus the size of the edit
+typedef struct {
+    rope_node* root;
+    uint64_t seed;
+} rope;
+
+/*
+    initialise an empty rope
+
+    NOTE: call rope_deinit to free
+*/
+rope rope_init() {
+    return (rope){.root = NULL, .seed = 0x9e3779b97f4a7c15ull};
+}
+size_t rope_node_size(rope_node* node) {
+    return node ? node->size : 0;
+}
+void rope_node_update(rope_node* node) {
+    node->size = rope_node_size(node->left) + node->len + rope_node_size(node->right);
+}
+/*
+    allocates a node holding len chars, len must be <= ROPE_CHUNK
+    NOTE: you usually won't have to call this yourself
+*/
+rope_node* rope_node_new(rope *self, const char* content, size_t len, uint64_t priority) {
+    rope_node* node = (rope_node*)malloc(sizeof(rope_node));
+    node->left = NULL;
+    node->right = NULL;
+    node->len = len;
+    node->size = len;
+    if (priority == 0) {
+        // xorshift64
+        self->seed ^= self->seed << 13;
+        self->seed ^= self->seed >> 7;
+        self->seed ^= self->seed << 17;
+        priority = self->seed;
+    }
+    node->priority = priority;
+    memcpy(node->chunk, content, len);
+    return node;
+}
+/*
+    joins two treaps where every char of one comes before every char of two
+    NOTE: you usually won't have to call this yourself
+*/
+rope_node* rope_merge(rope_node* one, rope_node* two) {
+    if (!one) {
+        return two;
+    }
+    if (!two) {
+        return one;
+    }
+    if (one->priority > two->priority) {
+        one->right = rope_merge(one->right, two);
+        rope_node_update(one);
+        return one;
+    }
+    two->left = rope_merge(one, two->left);
+    rope_node_update(two);
+    return two;
+}
+/*
+    splits a treap into the first pos chars and the rest, cutting a chunk in two if pos lands inside it
+    NOTE: you usually won't have to call this yourself
+*/
+void rope_split(rope *self, rope_node* node, size_t pos, rope_node** left, rope_node** right) {
+    if (!node) {
+        *left = NULL;
+        *right = NULL;
+        return;
+    }
+    size_t left_size = rope_node_size(node->left);
+    if (pos <= left_size) {
+        rope_split(self, node->left, pos, left, &node->left);
+        rope_node_update(node);
+        *right = node;
+    } else if (pos >= left_size + node->len) {
+        rope_split(self, node->right, pos - left_size - node->len, &node->right, right);
+        rope_node_update(node);
+        *left = node;
+    } else {
+        // the tail keeps the same priority so the heap order still holds under it
+        size_t cut = pos - left_size;
+        rope_node* tail = rope_node_new(self, node->chunk + cut, node->len - cut, node->priority);
+        tail->right = node->right;
+        node->right = NULL;
+        node->len = cut;
+        rope_node_update(node);
+        rope_node_update(tail);
+        *left = node;
+        *right = tail;
+    }
+}
+/*
+    builds a treap out of content, ROPE_CHUNK chars per node
+    NOTE: you usually won't have to call this yourself
+*/
+rope_node* rope_build(rope *self, const char* content, size_t len) {
+    rope_node* root = NULL;
+    for (size_t at = 0; at < len; at += ROPE_CHUNK) {
+        size_t take = len - at < ROPE_CHUNK ? len - at : ROPE_CHUNK;
+        root = rope_merge(root, rope_node_new(self, content + at, take, 0));
+    }
+    return root;
+}
+/*
+    create a rope from a view, copying the chars
+
+    NOTE: call rope_deinit to free
+*/
+rope rope_from_str(str content) {
+    rope self = rope_init();
+    self.root = rope_build(&self, content.ptr, content.len);
+    return self;
+}
+/* returns the number of chars in the rope */
+size_t rope_len(rope *self) {
+    return rope_node_size(self->root);
+}
+/*
+    inserts into the node holding pos when the chunk has room, fixing up sizes on the way back
+    returns false if it doesn't fit
+    NOTE: you usually won't have to call this yourself
+*/
+bool rope_insert_in_place(rope_node* node, size_t pos, const char* content, size_t len) {
+    if (!node) {
+        return false;
+    }
+    size_t left_size = rope_node_size(node->left);
+    bool done;
+    if (pos < left_size) {
+        done = rope_insert_in_place(node->left, pos, content, len);
+    } else if (pos <= left_size + node->len) {
+        size_t at = pos - left_size;
+        done = node->len + len <= ROPE_CHUNK;
+        if (done) {
+            memmove(node->chunk + at + len, node->chunk + at, node->len - at);
+            memcpy(node->chunk + at, content, len);
+            node->len += len;
+        }
+    } else {
+        done = rope_insert_in_place(node->right, pos - left_size - node->len, content, len);
+    }
+    if (done) {
+        node->size += len;
+    }
+    return done;
+}
+/*
+    inserts content at pos, pos == rope_len appends
+    returns the new len or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t rope_insert(rope *self, size_t pos, str content) {
+    if (pos > rope_len(self)) {
+        return (result_size_t){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    if (!rope_insert_in_place(self->root, pos, content.ptr, content.len)) {
+        rope_node* left;
+        rope_node* right;
+        rope_split(self, self->root, pos, &left, &right);
+        rope_node* middle = rope_build(self, content.ptr, content.len);
+        self->root = rope_merge(rope_merge(left, middle), right);
+    }
+    return (result_size_t){.err = ERR_NONE, .value = rope_len(self)};
+}
+void rope_node_free(rope_node* node) {
+    if (!node) {
+        return;
+    }
+    rope_node_free(node->left);
+    rope_node_free(node->right);
+    free(node);
+}
+/*
+    removes len chars starting at pos, len is clamped to the end of the rope
+    returns the new len or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t rope_remove(rope *self, size_t pos, size_t len) {
+    size_t total = rope_len(self);
+    if (pos > total) {
+        return (result_size_t){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    if (len > total - pos) {
+        len = total - pos;
+    }
+    rope_node* left;
+    rope_node* rest;
+    rope_node* middle;
+    rope_node* right;
+    rope_split(self, self->root, pos, &left, &rest);
+    rope_split(self, rest, len, &middle, &right);
+    rope_node_free(middle);
+    self->root = rope_merge(left, right);
+    return (result_size_t){.err = ERR_NONE, .value = rope_len(self)};
+}
+/* 
+    returns the char at index as an option
+    if index is out of bounds, returns .ok = false
+*/
+option_char rope_at(rope *self, size_t index) {
+    rope_node* node = self->root;
+    while (node) {
+        size_t left_size = rope_node_size(node->left);
+        if (index < left_size) {
+            node = node->left;
+        } else if (index < left_size + node->len) {
+            return (option_char){.ok = true, .value = node->chunk[index - left_size]};
+        } else {
+            index -= left_size + node->len;
+            node = node->right;
+        }
+    }
+    return (option_char){.ok = false, .value = 0};
+}
+/*
+    copies the chars of node's subtree that fall in [begin, end) to out
+    NOTE: you usually won't have to call this yourself
+*/
+void rope_node_copy(rope_node* node, size_t begin, size_t end, char* out) {
+    if (!node || begin >= end) {
+        return;
+    }
+    size_t left_size = rope_node_size(node->left);
+    if (begin < left_size) {
+        rope_node_copy(node->left, begin, end < left_size ? end : left_size, out);
+    }
+    size_t chunk_begin = begin > left_size ? begin - left_size : 0;
+    size_t chunk_end = end - left_size < node->len ? end - left_size : node->len;
+    if (end > left_size && chunk_begin < chunk_end) {
+        memcpy(out + (left_size + chunk_begin - begin), node->chunk + chunk_begin, chunk_end - chunk_begin);
+    }
+    size_t right_begin = left_size + node->len;
+    if (end > right_begin) {
+        size_t from = begin > right_begin ? begin : right_begin;
+        rope_node_copy(node->right, from - right_begin, end - right_begin, out + (from - begin));
+    }
+}
+/*
+    copies the chars in [begin, end) into a new string, end is clamped to the len
+
+    NOTE: call string_deinit to free
+*/
+string rope_substring(rope *self, size_t begin, size_t end) {
+    size_t len = rope_len(self);
+    if (end > len) {
+        end = len;
+    }
+    if (begin > end) {
+        begin = end;
+    }
+    string result = string_init();
+    string_reserve(&result, end - begin);
+    rope_node_copy(self->root, begin, end, string_data(&result));
+    string_set_len(&result, end - begin);
+    return result;
+}
+/*
+    flattens the whole rope into a new string
+
+    NOTE: call string_deinit to free
+*/
+string rope_to_string(rope *self) {
+    return rope_substring(self, 0, rope_len(self));
+}
+void rope_deinit(rope *self) {
+    rope_node_free(self->root);
+    self->root = NULL;
+}
+
+
+
+/* ################# GAP BUFFER ################# */
+
+
+
+// text with a hole (the gap) at the cursor, typing and deleting at the cursor only touch the gap's edges
+// moving the cursor moves the chars between the old and new position across the gap
+// .buf[0..gap_start) is the text before the cursor and .buf[gap_end..cap) the text after it
+typedef struct {
+    char* buf;
+    size_t cap;
+    size_t gap_start;
+    size_t gap_end;
+} gap_buffer;
+
+/*
+    initalise an empty gap buffer, nothing is allocated until the first insert
+
+    NOTE: call gap_buffer_deinit to free
+*/
+gap_buffer gap_buffer_init() {
+    return (gap_buffer){.buf = NULL, .cap = 0, .gap_start = 0, .gap_end = 0};
+}
+size_t gap_buffer_len(gap_buffer *self) {
+    return self->cap - (self->gap_end - self->gap_start);
+}
+/* returns where the next insert goes, from 0 to gap_buffer_len */
+size_t gap_buffer_cursor(gap_buffer *self) {
+    return self->gap_start;
+}
+/*
+    makes the gap at least n chars wide, at least doubling the buffer so typing stays amortised O(1)
+    NOTE: you usually won't have to call this yourself
+*/
+void gap_buffer_reserve(gap_buffer *self, size_t n) {
+    size_t gap = self->gap_end - self->gap_start;
+    if (gap >= n) {
+        return;
+    }
+    size_t after = self->cap - self->gap_end;
+    size_t cap = self->cap * 2;
+    if (cap < self->cap - gap + n) {
+        cap = self->cap - gap + n;
+    }
+    if (cap < 64) {
+        cap = 64;
+    }
+    self->buf = (char*)realloc(self->buf, cap);
+    if (after) {
+        memmove(self->buf + cap - after, self->buf + self->gap_end, after);
+    }
+    self->gap_end = cap - after;
+    self->cap = cap;
+}
+/*
+    moves the cursor to pos, copying the chars in between across the gap
+    returns the new cursor or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t gap_buffer_move(gap_buffer *self, size_t pos) {
+    if (pos > gap_buffer_len(self)) {
+        return (result_size_t){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    if (pos < self->gap_start) {
+        size_t count = self->gap_start - pos;
+        memmove(self->buf + self->gap_end - count, self->buf + pos, count);
+        self->gap_start -= count;
+        self->gap_end -= count;
+    } else if (pos > self->gap_start) {
+        size_t count = pos - self->gap_start;
+        memmove(self->buf + self->gap_start, self->buf + self->gap_end, count);
+        self->gap_start += count;
+        self->gap_end += count;
+    }
+    return (result_size_t){.err = ERR_NONE, .value = pos};
+}
+/* inserts content at the cursor and leaves the cursor after it, content may point into the buffer */
+void gap_buffer_insert(gap_buffer *self, str content) {
+    if (content.len == 0) {
+        return;
+    }
+    char* copy = NULL;
+    if (self->buf && content.ptr >= self->buf && content.ptr < self->buf + self->cap) {
+        // the gap is about to move under it, so take a copy first
+        copy = (char*)malloc(content.len);
+        memcpy(copy, content.ptr, content.len);
+        content.ptr = copy;
+    }
+    gap_buffer_reserve(self, content.len);
+    memcpy(self->buf + self->gap_start, content.ptr, content.len);
+    self->gap_start += content.len;
+    free(copy);
+}
+void gap_buffer_insert_char(gap_buffer *self, char elem) {
+    gap_buffer_reserve(self, 1);
+    self->buf[self->gap_start++] = elem;
+}
+/*
+    creates a gap buffer holding a copy of content with the cursor at the end
+
+    NOTE: call gap_buffer_deinit to free
+*/
+gap_buffer gap_buffer_from_str(str content) {
+    gap_buffer self = gap_buffer_init();
+    gap_buffer_insert(&self, content);
+    return self;
+}
+/*
+    removes up to n chars before the cursor (backspace)
+    returns the number removed
+*/
+size_t gap_buffer_delete_before(gap_buffer *self, size_t n) {
+    if (n > self->gap_start) {
+        n = self->gap_start;
+    }
+    self->gap_start -= n;
+    return n;
+}
+/*
+    removes up to n chars after the cursor (delete)
+    returns the number removed
+*/
+size_t gap_buffer_delete_after(gap_buffer *self, size_t n) {
+    if (n > self->cap - self->gap_end) {
+        n = self->cap - self->gap_end;
+    }
+    self->gap_end += n;
+    return n;
+}
+/*
+    moves the cursor to pos and inserts content there, like rope_insert
+    returns the new len or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t gap_buffer_insert_at(gap_buffer *self, size_t pos, str content) {
+    result_size_t moved = gap_buffer_move(self, pos);
+    if (moved.err) {
+        return moved;
+    }
+    gap_buffer_insert(self, content);
+    return (result_size_t){.err = ERR_NONE, .value = gap_buffer_len(self)};
+}
+/*
+    removes len chars starting at pos, len is clamped to the end, like rope_remove
+    returns the new len or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t gap_buffer_remove(gap_buffer *self, size_t pos, size_t len) {
+    result_size_t moved = gap_buffer_move(self, pos);
+    if (moved.err) {
+        return moved;
+    }
+    gap_buffer_delete_after(self, len);
+    return (result_size_t){.err = ERR_NONE, .value = gap_buffer_len(self)};
+}
+/*
+    returns the char at index as an option
+    if index is out of bounds, returns .ok = false
+*/
+option_char gap_buffer_at(gap_buffer *self, size_t index) {
+    if (index >= gap_buffer_len(self)) {
+        return (option_char){.ok = false, .value = 0};
+    }
+    size_t at = index < self->gap_start ? index : index + (self->gap_end - self->gap_start);
+    return (option_char){.ok = true, .value = self->buf[at]};
+}
+/*
+    returns the text as two views, {.one = before the cursor, .two = after it}
+    NOTE: the views are only valid until the buffer is next changed
+*/
+tuple_str_str gap_buffer_views(gap_buffer *self) {
+    return (tuple_str_str){
+        .one = str_from_bytes(self->buf, self->gap_start),
+        .two = str_from_bytes(self->buf + self->gap_end, self->cap - self->gap_end),
+    };
+}
+/*
+    copies the text into a string
+
+    NOTE: call string_deinit to free
+*/
+string gap_buffer_to_string(gap_buffer *self) {
+    tuple_str_str views = gap_buffer_views(self);
+    string result = string_init();
+    string_reserve(&result, views.one.len + views.two.len);
+    string_push_str(&result, views.one);
+    string_push_str(&result, views.two);
+    return result;
+}
+void gap_buffer_deinit(gap_buffer *self) {
+    free(self->buf);
+    *self = gap_buffer_init();
+}
+
+
+
+/* ################# PIECE TABLE ################# */
+
+
+
+// a run of .len chars starting at .start in the original text, or in the add buffer when .added
+typedef struct {
+    bool added;
+    size_t start;
+    size_t len;
+} piece;
+gen_dyn_with_deps(piece, piece);
+// {index, offset} into the pieces, also used for {first, end} ranges of a suffix array
+struct_tuple(size_t, size_t, size_t_size_t);
+
+// text as a list of pieces over two buffers that are never edited in place:
+// the original text and an append only buffer of everything inserted since
+// edits only split and rewrite pieces, so an insert costs O(pieces) no matter how big the text is
+typedef struct {
+    string original;
+    string added;
+    dyn_piece pieces;
+    size_t len;
+} piece_table;
+
+/*
+    creates a piece table over a copy of original
+
+    NOTE: call piece_table_deinit to free
+*/
+piece_table piece_table_init(str original) {
+    piece_table self = {
+        .original = string_from_str(original),
+        .added = string_init(),
+        .pieces = dyn_init_piece(),
+        .len = original.len,
+    };
+    if (original.len) {
+        dyn_push_piece(&self.pieces, (piece){.added = false, .start = 0, .len = original.len});
+    }
+    return self;
+}
+size_t piece_table_len(piece_table *self) {
+    return self->len;
+}
+/* returns the chars of piece index as a view, valid until the table is next changed */
+str piece_table_view(piece_table *self, size_t index) {
+    piece p = self->pieces.buf[index];
+    const char* base = string_cstr(p.added ? &self->added : &self->original);
+    return str_from_bytes(base + p.start, p.len);
+}
+/*
+    replaces count pieces from index with the with_count pieces in with
+    NOTE: you usually won't have to call this yourself
+*/
+void piece_table_splice(piece_table *self, size_t index, size_t count, const piece* with, size_t with_count) {
+    dyn_piece* pieces = &self->pieces;
+    size_t len = pieces->len - count + with_count;
+    if (len > pieces->cap) {
+        dyn_resize_with_add_piece(pieces, len - pieces->cap);
+    }
+    memmove(pieces->buf + index + with_count, pieces->buf + index + count, (pieces->len - index - count) * sizeof(piece));
+    memcpy(pieces->buf + index, with, with_count * sizeof(piece));
+    pieces->len = len;
+}
+/*
+    finds the piece holding char pos, returns {index, offset into it}
+    pos == len gives {pieces.len, 0}
+    NOTE: you usually won't have to call this yourself
+*/
+tuple_size_t_size_t piece_table_locate(piece_table *self, size_t pos) {
+    size_t start = 0;
+    for (size_t i = 0; i < self->pieces.len; i++) {
+        if (pos < start + self->pieces.buf[i].len) {
+            return (tuple_size_t_size_t){i, pos - start};
+        }
+        start += self->pieces.buf[i].len;
+    }
+    return (tuple_size_t_size_t){self->pieces.len, 0};
+}
+/*
+    inserts content at pos, pos == piece_table_len appends
+    typing right after the last insert grows its piece instead of adding a new one
+    returns the new len or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t piece_table_insert(piece_table *self, size_t pos, str content) {
+    if (pos > self->len) {
+        return (result_size_t){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    if (content.len == 0) {
+        return (result_size_t){.err = ERR_NONE, .value = self->len};
+    }
+    size_t start = string_len(&self->added);
+    string_push_str(&self->added, content);
+    piece inserted = {.added = true, .start = start, .len = content.len};
+    tuple_size_t_size_t at = piece_table_locate(self, pos);
+    if (at.two == 0) {
+        piece* before = at.one > 0 ? &self->pieces.buf[at.one - 1] : NULL;
+        if (before && before->added && before->start + before->len == start) {
+            before->len += content.len;
+        } else {
+            piece_table_splice(self, at.one, 0, &inserted, 1);
+        }
+    } else {
+        piece split = self->pieces.buf[at.one];
+        piece with[3] = {
+            {.added = split.added, .start = split.start, .len = at.two},
+            inserted,
+            {.added = split.added, .start = split.start + at.two, .len = split.len - at.two},
+        };
+        piece_table_splice(self, at.one, 1, with, 3);
+    }
+    self->len += content.len;
+    return (result_size_t){.err = ERR_NONE, .value = self->len};
+}
+/*
+    removes len chars starting at pos, len is clamped to the end
+    the chars stay in their buffers, only the pieces change
+    returns the new len or ERR_INDEX_OUT_OF_BOUNDS if pos is past the end
+*/
+result_size_t piece_table_remove(piece_table *self, size_t pos, size_t len) {
+    if (pos > self->len) {
+        return (result_size_t){.err = ERR_INDEX_OUT_OF_BOUNDS};
+    }
+    if (len > self->len - pos) {
+        len = self->len - pos;
+    }
+    if (len == 0) {
+        return (result_size_t){.err = ERR_NONE, .value = self->len};
+    }
+    tuple_size_t_size_t first = piece_table_locate(self, pos);
+    // the last removed char is at pos + len - 1
+    tuple_size_t_size_t last = piece_table_locate(self, pos + len - 1);
+    piece head = self->pieces.buf[first.one];
+    piece tail = self->pieces.buf[last.one];
+    piece with[2];
+    size_t with_count = 0;
+    if (first.two > 0) {
+        with[with_count++] = (piece){.added = head.added, .start = head.start, .len = first.two};
+    }
+    if (last.two + 1 < tail.len) {
+        with[with_count++] = (piece){.added = tail.added, .start = tail.start + last.two + 1, .len = tail.len - last.two - 1};
+    }
+    piece_table_splice(self, first.one, last.one - first.one + 1, with, with_count);
+    self->len -= len;
+    return (result_size_t){.err = ERR_NONE, .value = self->len};
+}
+/*
+    returns the char at index as an option
+    if index is out of bounds, returns .ok = false
+*/
+option_char piece_table_at(piece_table *self, size_t index) {
+    if (index >= self->len) {
+        return (option_char){.ok = false, .value = 0};
+    }
+    tuple_size_t_size_t at = piece_table_locate(self, index);
+    return (option_char){.ok = true, .value = piece_table_view(self, at.one).ptr[at.two]};
+}
+/*
+    copies the text into a string, allocated once at its exact size
+
+    NOTE: call string_deinit to free
+*/
+string piece_table_to_string(piece_table *self) {
+    string result = string_init();
+    string_reserve(&result, self->len);
+    for (size_t i = 0; i < self->pieces.len; i++) {
+        string_push_str(&result, piece_table_view(self, i));
+    }
+    return result;
+}
+void piece_table_deinit(piece_table *self) {
+    string_deinit(&self->original);
+    string_deinit(&self->added);
+    dyn_deinit_piece(&self->pieces);
+    self->len = 0;
+}
+
+
+
+/* ################# NUMBER FORMATTING ################# */
+
+
+
+struct_result(int64_t, i64);
+struct_result(double, f64);
+
+// "00" "01" ... "99", lets integer formatting write two digits per division
+const char NUMBER_DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/*
+    writes value in decimal ending right before end, two digits at a time
+    returns a pointer to the first digit
+    NOTE: you usually won't have to call this yourself
+*/
+char* number_format_u64(uint64_t value, char* end) {
+    char* at = end;
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        at -= 2;
+        at[0] = NUMBER_DIGIT_PAIRS[pair];
+        at[1] = NUMBER_DIGIT_PAIRS[pair + 1];
+    }
+    if (value >= 10) {
+        at -= 2;
+        at[0] = NUMBER_DIGIT_PAIRS[value * 2];
+        at[1] = NUMBER_DIGIT_PAIRS[value * 2 + 1];
+    } else {
+        *--at = (char)('0' + value);
+    }
+    return at;
+}
+/* pushes value in decimal */
+void string_push_u64(string *self, uint64_t value) {
+    char buf[20];
+    char* end = buf + sizeof(buf);
+    char* begin = number_format_u64(value, end);
+    string_push_bytes(self, begin, end - begin);
+}
+/* pushes value in decimal with a leading '-' for negatives */
+void string_push_i64(string *self, int64_t value) {
+    char buf[21];
+    char* end = buf + sizeof(buf);
+    // negate in unsigned so INT64_MIN doesn't overflow
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    char* begin = number_format_u64(magnitude, end);
+    if (value < 0) {
+        *--begin = '-';
+    }
+    string_push_bytes(self, begin, end - begin);
+}
+
+// lowest power of ten in NUMBER_POW10_128
+#define NUMBER_POW10_128_MIN -342
+// 10^e for e = -342, ..., 324 as 128 bit significands rounded down with the top bit set, high word then low word
+const uint64_t NUMBER_POW10_128[] = {
+    0xeef453d6923bd65aull, 0x113faa2906a13b3full, 0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull,
+    0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull, 0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull,
+    0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull, 0xb64ec836a47146f9ull, 0x9748e2826cdee284ull,
+    0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull, 0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull,
+    0xb208ef855c969f4full, 0xbdbd2d335e51a935ull, 0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull,
+    0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull, 0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull,
+    0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull, 0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull,
+    0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull, 0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull,
+    0x84a57695fe98746dull, 0x014bb630f7604b57ull, 0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull,
+    0xcf42894a5dce35eaull, 0x52064cac828675b9ull, 0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull,
+    0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull, 0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull,
+    0xfd00b897478238d0ull, 0x8920b098955522b4ull, 0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull,
+    0xc5a890362fddbc62ull, 0xeb2189f734aa831dull, 0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull,
+    0x9a6bb0aa55653b2dull, 0x47b233c92125366eull, 0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull,
+    0xf148440a256e2c76ull, 0xc00670ea43ca250dull, 0x96cd2a865764dbcaull, 0x380406926a5e5728ull,
+    0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull, 0xeba09271e88d976bull, 0xf7864a44c633682eull,
+    0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull, 0xb8157268fdae9e4cull, 0x5960ea05bad82964ull,
+    0xe61acf033d1a45dfull, 0x6fb92487298e33bdull, 0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull,
+    0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull, 0xe0b62e2929aba83cull, 0x331acdabfe94de87ull,
+    0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull, 0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull,
+    0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull, 0x892731ac9faf056eull, 0xbe311c083a225cd2ull,
+    0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull, 0xd64d3d9db981787dull, 0x092cbbccdad5b108ull,
+    0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull, 0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull,
+    0xd1476e2c07286faaull, 0x1af5af660db4aee1ull, 0x82cca4db847945caull, 0x50d98d9fc890ed4dull,
+    0xa37fce126597973cull, 0xe50ff107bab528a0ull, 0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull,
+    0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull, 0x9faacf3df73609b1ull, 0x77b191618c54e9acull,
+    0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull, 0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull,
+    0x9becce62836ac577ull, 0x4ee367f9430aec32ull, 0xc2e801fb244576d5ull, 0x229c41f793cda73full,
+    0xf3a20279ed56d48aull, 0x6b43527578c1110full, 0x9845418c345644d6ull, 0x830a13896b78aaa9ull,
+    0xbe5691ef416bd60cull, 0x23cc986bc656d553ull, 0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull,
+    0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull, 0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull,
+    0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull, 0x91376c36d99995beull, 0x23100809b9c21fa1ull,
+    0xb58547448ffffb2dull, 0xabd40a0c2832a78aull, 0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull,
+    0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull, 0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull,
+    0xdd95317f31c7fa1dull, 0x40405643d711d583ull, 0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull,
+    0xad1c8eab5ee43b66ull, 0xda3243650005eecfull, 0xd863b256369d4a40ull, 0x90bed43e40076a82ull,
+    0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull, 0xa90de3535aaae202ull, 0x711515d0a205cb36ull,
+    0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull, 0x8412d9991ed58091ull, 0xe858790afe9486c2ull,
+    0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull, 0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full,
+    0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull, 0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull,
+    0xc987434744ac874eull, 0xa327ffb266b56220ull, 0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull,
+    0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull, 0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull,
+    0xf6019da07f549b2bull, 0x7e2a53a146606a48ull, 0x99c102844f94e0fbull, 0x2eda7444cbfc426dull,
+    0xc0314325637a1939ull, 0xfa911155fefb5308ull, 0xf03d93eebc589f88ull, 0x793555ab7eba27caull,
+    0x96267c7535b763b5ull, 0x4bc1558b2f3458deull, 0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull,
+    0xea9c227723ee8bcbull, 0x465e15a979c1cadcull, 0x92a1958a7675175full, 0x0bfacd89ec191ec9ull,
+    0xb749faed14125d36ull, 0xcef980ec671f667bull, 0xe51c79a85916f484ull, 0x82b7e12780e7401aull,
+    0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull, 0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull,
+    0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull, 0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull,
+    0xaecc49914078536dull, 0x58fae9f773886e18ull, 0xda7f5bf590966848ull, 0xaf39a475506a899eull,
+    0x888f99797a5e012dull, 0x6d8406c952429603ull, 0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull,
+    0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull, 0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full,
+    0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull, 0xd0601d8efc57b08bull, 0xf13b94daf124da26ull,
+    0x823c12795db6ce57ull, 0x76c53d08d6b70858ull, 0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull,
+    0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull, 0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull,
+    0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull, 0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull,
+    0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull, 0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull,
+    0xc21094364dfb5636ull, 0x985915fc12f542e4ull, 0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull,
+    0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull, 0xbd8430bd08277231ull, 0x50c6ff782a838353ull,
+    0xece53cec4a314ebdull, 0xa4f8bf5635246428ull, 0x940f4613ae5ed136ull, 0x871b7795e136be99ull,
+    0xb913179899f68584ull, 0x28e2557b59846e3full, 0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull,
+    0x9096ea6f3848984full, 0x3ff0d2c85def7621ull, 0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull,
+    0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull, 0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull,
+    0xb080392cc4349decull, 0xbd8d794d96aacfb3ull, 0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull,
+    0x89e42caaf9491b60ull, 0xf41686c49db57244ull, 0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull,
+    0xd77485cb25823ac7ull, 0x7d633293366b828bull, 0x86a8d39ef77164bcull, 0xae5dff9c02033197ull,
+    0xa8530886b54dbdebull, 0xd9f57f830283fdfcull, 0xd267caa862a12d66ull, 0xd072df63c324fd7bull,
+    0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull, 0xa46116538d0deb78ull, 0x52d9be85f074e608ull,
+    0xcd795be870516656ull, 0x67902e276c921f8bull, 0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull,
+    0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull, 0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull,
+    0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull, 0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull,
+    0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull, 0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull,
+    0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull, 0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull,
+    0xef340a98172aace4ull, 0x86fb897116c87c34ull, 0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull,
+    0xbae0a846d2195712ull, 0x8974836059cca109ull, 0xe998d258869facd7ull, 0x2bd1a438703fc94bull,
+    0x91ff83775423cc06ull, 0x7b6306a34627ddcfull, 0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull,
+    0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull, 0x8e938662882af53eull, 0x547eb47b7282ee9cull,
+    0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull, 0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull,
+    0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull, 0xae0b158b4738705eull, 0x9624ab50b148d445ull,
+    0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull, 0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull,
+    0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull, 0xd47487cc8470652bull, 0x7647c3200069671full,
+    0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull, 0xa5fb0a17c777cf09ull, 0xf468107100525890ull,
+    0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull, 0x81ac1fe293d599bfull, 0xc6f14cd848405530ull,
+    0xa21727db38cb002full, 0xb8ada00e5a506a7cull, 0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull,
+    0xfd442e4688bd304aull, 0x908f4a166d1da663ull, 0x9e4a9cec15763e2eull, 0x9a598e4e043287feull,
+    0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull, 0xf7549530e188c128ull, 0xd12bee59e68ef47cull,
+    0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull, 0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull,
+    0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull, 0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull,
+    0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull, 0xebdf661791d60f56ull, 0x111b495b3464ad21ull,
+    0x936b9fcebb25c995ull, 0xcab10dd900beec34ull, 0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull,
+    0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull, 0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull,
+    0xb3f4e093db73a093ull, 0x59ed216765690f56ull, 0xe0f218b8d25088b8ull, 0x306869c13ec3532cull,
+    0x8c974f7383725573ull, 0x1e414218c73a13fbull, 0xafbd2350644eeacfull, 0xe5d1929ef90898faull,
+    0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull, 0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull,
+    0xab9eb47c81f5114full, 0x066ea92f3f326564ull, 0xd686619ba27255a2ull, 0xc80a537b0efefebdull,
+    0x8613fd0145877585ull, 0xbd06742ce95f5f36ull, 0xa798fc4196e952e7ull, 0x2c48113823b73704ull,
+    0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull, 0x82ef85133de648c4ull, 0x9a984d73dbe722fbull,
+    0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull, 0xcc963fee10b7d1b3ull, 0x318df905079926a8ull,
+    0xffbbcfe994e5c61full, 0xfdf17746497f7052ull, 0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull,
+    0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull, 0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull,
+    0x9c1661a651213e2dull, 0x06bea10ca65c084eull, 0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull,
+    0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull, 0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull,
+    0xbe89523386091465ull, 0xf6bbb397f1135823ull, 0xee2ba6c0678b597full, 0x746aa07ded582e2cull,
+    0x94db483840b717efull, 0xa8c2a44eb4571cdcull, 0xba121a4650e4ddebull, 0x92f34d62616ce413ull,
+    0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull, 0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull,
+    0xb5b5ada8aaff80b8ull, 0x0d819992132456baull, 0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull,
+    0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull, 0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull,
+    0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull, 0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull,
+    0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull, 0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull,
+    0x87625f056c7c4a8bull, 0x11471cd764ad4972ull, 0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull,
+    0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull, 0x843610cb4bf160cbull, 0xcedf722a585139baull,
+    0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull, 0xce947a3da6a9273eull, 0x733d226229feea32ull,
+    0x811ccc668829b887ull, 0x0806357d5a3f525full, 0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull,
+    0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull, 0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull,
+    0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull, 0xc5029163f384a931ull, 0x0a9e795e65d4df11ull,
+    0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull, 0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull,
+    0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull, 0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull,
+    0x964e858c91ba2655ull, 0x3a6a07f8d510f86full, 0xbbe226efb628afeaull, 0x890489f70a55368bull,
+    0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull, 0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull,
+    0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull, 0xe55990879ddcaabdull, 0xcc420a6a101d0515ull,
+    0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull, 0xb32df8e9f3546564ull, 0x47939822dc96abf9ull,
+    0xdff9772470297ebdull, 0x59787e2b93bc56f7ull, 0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull,
+    0xaefae51477a06b03ull, 0xede622920b6b23f1ull, 0xdab99e59958885c4ull, 0xe95fab368e45ecedull,
+    0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull, 0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull,
+    0xd59944a37c0752a2ull, 0x4be76d3346f0495full, 0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull,
+    0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull, 0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull,
+    0x825ecc24c873782full, 0x8ed400668c0c28c8ull, 0xa2f67f2dfa90563bull, 0x728900802f0f32faull,
+    0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull, 0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull,
+    0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull, 0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull,
+    0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull, 0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull,
+    0xc24452da229b021bull, 0xfbe85badce996168ull, 0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull,
+    0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull, 0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull,
+    0xed246723473e3813ull, 0x290123e9aab23b68ull, 0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull,
+    0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull, 0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull,
+    0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull, 0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull,
+    0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull, 0x8d590723948a535full, 0x579c487e5a38ad0eull,
+    0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull, 0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull,
+    0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull, 0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full,
+    0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full, 0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull,
+    0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull, 0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull,
+    0x83a3eeeef9153e89ull, 0x1953cf68300424acull, 0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull,
+    0xcdb02555653131b6ull, 0x3792f412cb06794dull, 0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull,
+    0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull, 0xc8de047564d20a8bull, 0xf245825a5a445275ull,
+    0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull, 0x9ced737bb6c4183dull, 0x55464dd69685606bull,
+    0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull, 0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull,
+    0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull, 0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull,
+    0xef73d256a5c0f77cull, 0x963e66858f6d4440ull, 0x95a8637627989aadull, 0xdde7001379a44aa8ull,
+    0xbb127c53b17ec159ull, 0x5560c018580d5d52ull, 0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull,
+    0x9226712162ab070dull, 0xcab3961304ca70e8ull, 0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull,
+    0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull, 0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull,
+    0xb267ed1940f1c61cull, 0x55f038b237591ed3ull, 0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull,
+    0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull, 0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull,
+    0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull, 0x881cea14545c7575ull, 0x7e50d64177da2e54ull,
+    0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull, 0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull,
+    0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull, 0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull,
+    0xcfb11ead453994baull, 0x67de18eda5814af2ull, 0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull,
+    0xa2425ff75e14fc31ull, 0xa1258379a94d028dull, 0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull,
+    0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull, 0x9e74d1b791e07e48ull, 0x775ea264cf55347dull,
+    0xc612062576589ddaull, 0x95364afe032a819dull, 0xf79687aed3eec551ull, 0x3a83ddbd83f52204ull,
+    0x9abe14cd44753b52ull, 0xc4926a9672793542ull, 0xc16d9a0095928a27ull, 0x75b7053c0f178293ull,
+    0xf1c90080baf72cb1ull, 0x5324c68b12dd6338ull, 0x971da05074da7beeull, 0xd3f6fc16ebca5e03ull,
+    0xbce5086492111aeaull, 0x88f4bb1ca6bcf584ull, 0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e5ull,
+    0x9392ee8e921d5d07ull, 0x3aff322e62439fcfull, 0xb877aa3236a4b449ull, 0x09befeb9fad487c2ull,
+    0xe69594bec44de15bull, 0x4c2ebe687989a9b3ull, 0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a10ull,
+    0xb424dc35095cd80full, 0x538484c19ef38c94ull, 0xe12e13424bb40e13ull, 0x2865a5f206b06fb9ull,
+    0x8cbccc096f5088cbull, 0xf93f87b7442e45d3ull, 0xafebff0bcb24aafeull, 0xf78f69a51539d748ull,
+    0xdbe6fecebdedd5beull, 0xb573440e5a884d1bull, 0x89705f4136b4a597ull, 0x31680a88f8953030ull,
+    0xabcc77118461cefcull, 0xfdc20d2b36ba7c3dull, 0xd6bf94d5e57a42bcull, 0x3d32907604691b4cull,
+    0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b10full, 0xa7c5ac471b478423ull, 0x0fcf80dc33721d53ull,
+    0xd1b71758e219652bull, 0xd3c36113404ea4a8ull, 0x83126e978d4fdf3bull, 0x645a1cac083126e9ull,
+    0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a3ull, 0xccccccccccccccccull, 0xccccccccccccccccull,
+    0x8000000000000000ull, 0x0000000000000000ull, 0xa000000000000000ull, 0x0000000000000000ull,
+    0xc800000000000000ull, 0x0000000000000000ull, 0xfa00000000000000ull, 0x0000000000000000ull,
+    0x9c40000000000000ull, 0x0000000000000000ull, 0xc350000000000000ull, 0x0000000000000000ull,
+    0xf424000000000000ull, 0x0000000000000000ull, 0x9896800000000000ull, 0x0000000000000000ull,
+    0xbebc200000000000ull, 0x0000000000000000ull, 0xee6b280000000000ull, 0x0000000000000000ull,
+    0x9502f90000000000ull, 0x0000000000000000ull, 0xba43b74000000000ull, 0x0000000000000000ull,
+    0xe8d4a51000000000ull, 0x0000000000000000ull, 0x9184e72a00000000ull, 0x0000000000000000ull,
+    0xb5e620f480000000ull, 0x0000000000000000ull, 0xe35fa931a0000000ull, 0x0000000000000000ull,
+    0x8e1bc9bf04000000ull, 0x0000000000000000ull, 0xb1a2bc2ec5000000ull, 0x0000000000000000ull,
+    0xde0b6b3a76400000ull, 0x0000000000000000ull, 0x8ac7230489e80000ull, 0x0000000000000000ull,
+    0xad78ebc5ac620000ull, 0x0000000000000000ull, 0xd8d726b7177a8000ull, 0x0000000000000000ull,
+    0x878678326eac9000ull, 0x0000000000000000ull, 0xa968163f0a57b400ull, 0x0000000000000000ull,
+    0xd3c21bcecceda100ull, 0x0000000000000000ull, 0x84595161401484a0ull, 0x0000000000000000ull,
+    0xa56fa5b99019a5c8ull, 0x0000000000000000ull, 0xcecb8f27f4200f3aull, 0x0000000000000000ull,
+    0x813f3978f8940984ull, 0x4000000000000000ull, 0xa18f07d736b90be5ull, 0x5000000000000000ull,
+    0xc9f2c9cd04674edeull, 0xa400000000000000ull, 0xfc6f7c4045812296ull, 0x4d00000000000000ull,
+    0x9dc5ada82b70b59dull, 0xf020000000000000ull, 0xc5371912364ce305ull, 0x6c28000000000000ull,
+    0xf684df56c3e01bc6ull, 0xc732000000000000ull, 0x9a130b963a6c115cull, 0x3c7f400000000000ull,
+    0xc097ce7bc90715b3ull, 0x4b9f100000000000ull, 0xf0bdc21abb48db20ull, 0x1e86d40000000000ull,
+    0x96769950b50d88f4ull, 0x1314448000000000ull, 0xbc143fa4e250eb31ull, 0x17d955a000000000ull,
+    0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull, 0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull,
+    0xb7abc627050305adull, 0xf14a3d9e40000000ull, 0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull,
+    0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull, 0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull,
+    0xe0352f62a19e306eull, 0xd50b2037ad200000ull, 0x8c213d9da502de45ull, 0x4526f422cc340000ull,
+    0xaf298d050e4395d6ull, 0x9670b12b7f410000ull, 0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull,
+    0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull, 0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull,
+    0xd5d238a4abe98068ull, 0x72a4904598d6d880ull, 0x85a36366eb71f041ull, 0x47a6da2b7f864750ull,
+    0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull, 0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull,
+    0x82818f1281ed449full, 0xbff8f10e7a8921a4ull, 0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull,
+    0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull, 0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull,
+    0x9f4f2726179a2245ull, 0x01d762422c946590ull, 0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull,
+    0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull, 0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full,
+    0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull, 0xf316271c7fc3908aull, 0x8bef464e3945ef7aull,
+    0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull, 0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull,
+    0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull, 0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull,
+    0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull, 0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull,
+    0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull, 0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull,
+    0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull, 0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull,
+    0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull, 0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull,
+    0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull, 0xacb92ed9397bf996ull, 0x49c2c37f07965404ull,
+    0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull, 0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull,
+    0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull, 0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull,
+    0x83c7088e1aab65dbull, 0x792667c6da79e0faull, 0xa4b8cab1a1563f52ull, 0x577001b891185938ull,
+    0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull, 0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull,
+    0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull, 0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull,
+    0xfb5878494ace3a5full, 0x04ab48a04065c723ull, 0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull,
+    0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull, 0xf5746577930d6500ull, 0xca8f44ec7ee36479ull,
+    0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull, 0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull,
+    0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull, 0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull,
+    0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull, 0xea1575143cf97226ull, 0xf52d09d71a3293bdull,
+    0x924d692ca61be758ull, 0x593c2626705f9c56ull, 0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull,
+    0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull, 0x8edf98b59a373fecull, 0x4724bd4189bd5eacull,
+    0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull, 0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull,
+    0x8b865b215899f46cull, 0xbd79e0d20082ee74ull, 0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull,
+    0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull, 0x884134fe908658b2ull, 0x3109058d147fdcddull,
+    0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull, 0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull,
+    0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull, 0xa6539930bf6bff45ull, 0x84db8346b786151cull,
+    0xcfe87f7cef46ff16ull, 0xe612641865679a63ull, 0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull,
+    0xa26da3999aef7749ull, 0xe3be5e330f38f09dull, 0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull,
+    0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull, 0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull,
+    0xc646d63501a1511dull, 0xb281e1fd541501b8ull, 0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull,
+    0x9ae757596946075full, 0x3375788de9b06958ull, 0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull,
+    0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull, 0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull,
+    0xbd176620a501fbffull, 0xb650e5a93bc3d898ull, 0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull,
+    0x93ba47c980e98cdfull, 0xc66f336c36b10137ull, 0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull,
+    0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull, 0x9043ea1ac7e41392ull, 0x87c89837ad68db2full,
+    0xb454e4a179dd1877ull, 0x29babe4598c311fbull, 0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull,
+    0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull, 0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full,
+    0xdc21a1171d42645dull, 0x76707543f4fa1f73ull, 0x899504ae72497ebaull, 0x6a06494a791c53a8ull,
+    0xabfa45da0edbde69ull, 0x0487db9d17636892ull, 0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull,
+    0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull, 0xa7f26836f282b732ull, 0x8e6cac7768d7141eull,
+    0xd1ef0244af2364ffull, 0x3207d795430cd926ull, 0x8335616aed761f1full, 0x7f44e6bd49e807b8ull,
+    0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull, 0xcd036837130890a1ull, 0x36dba887c37a8c0full,
+    0x802221226be55a64ull, 0xc2494954da2c9789ull, 0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull,
+    0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull, 0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull,
+    0x9c69a97284b578d7ull, 0xff2a760414536efbull, 0xc38413cf25e2d70dull, 0xfef5138519684abaull,
+    0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull, 0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull,
+    0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull, 0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull,
+    0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull, 0xba756174393d88dfull, 0x94f971119aeef9e4ull,
+    0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull, 0x91abb422ccb812eeull, 0xac62e055c10ab33aull,
+    0xb616a12b7fe617aaull, 0x577b986b314d6009ull, 0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull,
+    0x8e41ade9fbebc27dull, 0x14588f13be847307ull, 0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull,
+    0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull, 0x8aec23d680043beeull, 0x25de7bb9480d5854ull,
+    0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull, 0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull,
+    0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull, 0xa99541bf57452b28ull, 0x353a1607ac744a53ull,
+    0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull, 0x847c9b5d7c2e09b7ull, 0x69956135febada11ull,
+    0xa59bc234db398c25ull, 0x43fab9837e699095ull, 0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull,
+    0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull, 0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull,
+    0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull, 0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull,
+    0x9defbf01b061adabull, 0x3a0888136afa64a7ull, 0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull,
+    0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull, 0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull,
+    0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull, 0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull,
+    0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull, 0xbc4665b596706114ull, 0x873d5d9f0dde1feeull,
+    0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull, 0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull,
+    0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full, 0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull,
+    0x8fa475791a569d10ull, 0xf96e017d694487bcull, 0xb38d92d760ec4455ull, 0x37c981dcc395a9acull,
+    0xe070f78d3927556aull, 0x85bbe253f47b1417ull, 0x8c469ab843b89562ull, 0x93956d7478ccec8eull,
+    0xaf58416654a6babbull, 0x387ac8d1970027b2ull, 0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull,
+    0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull, 0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull,
+    0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull, 0x85c7056562757456ull, 0xf6872d5667844e49ull,
+    0xa738c6bebb12d16cull, 0xb428f8ac016561dbull, 0xd106f86e69d785c7ull, 0xe13336d701beba52ull,
+    0x82a45b450226b39cull, 0xecc0024661173473ull, 0xa34d721642b06084ull, 0x27f002d7f95d0190ull,
+    0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull, 0xff290242c83396ceull, 0x7e67047175a15271ull,
+    0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull, 0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull,
+    0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull, 0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull,
+    0xc2abf989935ddbfeull, 0x6acff893d00ea435ull, 0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull,
+    0x98165af37b2153deull, 0xc3727a337a8b704aull, 0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull,
+    0xeda2ee1c7064130cull, 0x1162def06f79df73ull, 0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull,
+    0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull, 0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull,
+    0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull, 0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull,
+    0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull, 0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull,
+    0xb10d8e1456105dadull, 0x7425a83e872c5f47ull, 0xdd50f1996b947518ull, 0xd12f124e28f77719ull,
+    0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full, 0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull,
+    0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull, 0x8714a775e3e95c78ull, 0x65acfaec34810a71ull,
+    0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull, 0xd31045a8341ca07cull, 0x1ede48111209a050ull,
+    0x83ea2b892091e44dull, 0x934aed0aab460432ull, 0xa4e4b66b68b65d60ull, 0xf81da84d5617853full,
+    0xce1de40642e3f4b9ull, 0x36251260ab9d668eull, 0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull,
+    0xa1075a24e4421730ull, 0xb24cf65b8612f81full, 0xc94930ae1d529cfcull, 0xdee033f26797b627ull,
+    0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull, 0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull,
+    0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull, 0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull,
+    0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull, 0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull,
+    0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull, 0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull,
+    0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull, 0xea53df5fd18d5513ull, 0x84c86189216dc5edull,
+    0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull, 0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull,
+    0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull, 0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull,
+    0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull, 0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull,
+    0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull, 0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull,
+    0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull, 0x8865899617fb1871ull, 0x7e2fa67c7a658892ull,
+    0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull, 0xd51ea6fa85785631ull, 0x552a74227f3ea565ull,
+    0x8533285c936b35deull, 0xd53a88958f87275full, 0xa67ff273b8460356ull, 0x8a892abaf368f137ull,
+    0xd01fef10a657842cull, 0x2d2b7569b0432d85ull, 0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull,
+    0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full, 0xcb3f2f7642717713ull, 0x241c70a936219a73ull,
+    0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull, 0x9ec95d1463e8a506ull, 0xf4363804324a40aaull,
+    0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull, 0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull,
+    0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull, 0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull,
+    0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull, 0x976e41088617ca01ull, 0xd5be0503e085d813ull,
+    0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull, 0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull,
+    0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull, 0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull,
+    0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull, 0x906a617d450187e2ull, 0x27fb2b80668b24c5ull,
+    0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull, 0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull,
+    0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull, 0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull,
+    0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull, 0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull,
+    0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull, 0xd732290fbacaf133ull, 0xa97c177947ad4095ull,
+    0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull, 0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull,
+    0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull, 0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull,
+    0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull, 0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull,
+    0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull, 0xa0555e361951c366ull, 0xd7e105bcc332621full,
+    0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull, 0xfa856334878fc150ull, 0xb14f98f6f0feb951ull,
+    0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull, 0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull,
+    0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull, 0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull,
+    0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull, 0xeeea5d5004981478ull, 0x1858ccfce06cac74ull,
+    0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull, 0xbaa718e68396cffdull, 0xd30560258f54e6baull,
+    0xe950df20247c83fdull, 0x47c6b82ef32a2069ull, 0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull,
+    0xb6472e511c81471dull, 0xe0133fe4adf8e952ull, 0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull,
+    0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull, 0xb201833b35d63f73ull, 0x2cd2cc6551e513daull,
+    0xde81e40a034bcf4full, 0xf8077f7ea65e58d1ull, 0x8b112e86420f6191ull, 0xfb04afaf27faf782ull,
+    0xadd57a27d29339f6ull, 0x79c5db9af1f9b563ull, 0xd94ad8b1c7380874ull, 0x18375281ae7822bcull,
+    0x87cec76f1c830548ull, 0x8f2293910d0b15b5ull, 0xa9c2794ae3a3c69aull, 0xb2eb3875504ddb22ull,
+    0xd433179d9c8cb841ull, 0x5fa60692a46151ebull, 0x849feec281d7f328ull, 0xdbc7c41ba6bcd333ull,
+    0xa5c7ea73224deff3ull, 0x12b9b522906c0800ull, 0xcf39e50feae16befull, 0xd768226b34870a00ull,
+    0x81842f29f2cce375ull, 0xe6a1158300d46640ull, 0xa1e53af46f801c53ull, 0x60495ae3c1097fd0ull,
+    0xca5e89b18b602368ull, 0x385bb19cb14bdfc4ull, 0xfcf62c1dee382c42ull, 0x46729e03dd9ed7b5ull,
+    0x9e19db92b4e31ba9ull, 0x6c07a2c26a8346d1ull,
+};
+// every power of ten that is exactly representable as a double
+const double NUMBER_POW10_F64[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// floor(e * log10(2)), valid for |e| <= 5456721
+int number_flog10_pow2(int e) {
+    return (int)((int64_t)e * 661971961083 >> 41);
+}
+// floor(e * log10(2) + log10(3 / 4)), valid for |e| <= 5456721
+int number_flog10_three_quarters_pow2(int e) {
+    return (int)(((int64_t)e * 661971961083 - 274743187321) >> 41);
+}
+// floor(e * log2(10)), valid for |e| <= 1233
+int number_flog2_pow10(int e) {
+    return (int)((int64_t)e * 913124641741 >> 38);
+}
+/*
+    rounds g * cp / 2^127 to odd, where g = g1 * 2^63 + g0 is a 126 bit power of ten
+    NOTE: you usually won't have to call this yourself
+*/
+uint64_t number_round_to_odd(uint64_t g1, uint64_t g0, uint64_t cp) {
+    uint64_t x1 = (uint64_t)(((__uint128_t)g0 * cp) >> 64);
+    __uint128_t y = (__uint128_t)g1 * cp;
+    uint64_t z = ((uint64_t)y >> 1) + x1;
+    uint64_t vbp = (uint64_t)(y >> 64) + (z >> 63);
+    const uint64_t mask = ((uint64_t)1 << 63) - 1;
+    return vbp | (((z & mask) + mask) >> 63);
+}
+/*
+    schubfach ("the schubfach way to render doubles" by raffaello giulietti), following his DoubleToDecimal
+    finds the shortest decimal f * 10^e inside the rounding interval of c * 2^q, the closest one if there are several
+    java wants two digits at least, so unlike DoubleToDecimal this already tries one digit less from s >= 10 on
+    NOTE: you usually won't have to call this yourself
+*/
+void number_schubfach_decimal(int q, uint64_t c, uint64_t* f, int* e) {
+    const uint64_t c_min = (uint64_t)1 << 52;
+    uint64_t out = c & 1;
+    uint64_t cb = c << 2;
+    uint64_t cbr = cb + 2;
+    uint64_t cbl;
+    int k;
+    // the interval is lopsided at powers of two, the double below is only half as far
+    if (c != c_min || q == -1074) {
+        cbl = cb - 2;
+        k = number_flog10_pow2(q);
+    } else {
+        cbl = cb - 1;
+        k = number_flog10_three_quarters_pow2(q);
+    }
+    int h = q + number_flog2_pow10(-k) + 2;
+    // g = floor(10^-k * 2^-r) + 1 in 126 bits, the rounded down 128 bit table entry shifted by 2
+    const uint64_t* power = &NUMBER_POW10_128[2 * (-k - NUMBER_POW10_128_MIN)];
+    __uint128_t g = ((((__uint128_t)power[0] << 64) | power[1]) >> 2) + 1;
+    uint64_t g1 = (uint64_t)(g >> 63);
+    uint64_t g0 = (uint64_t)g & (((uint64_t)1 << 63) - 1);
+    uint64_t vb = number_round_to_odd(g1, g0, cb << h);
+    uint64_t vbl = number_round_to_odd(g1, g0, cbl << h);
+    uint64_t vbr = number_round_to_odd(g1, g0, cbr << h);
+
+    uint64_t s = vb >> 2;
+    if (s >= 10) {
+        // one digit less if exactly one of the two neighbouring multiples of 10 is inside the interval
+        uint64_t sp10 = s / 10 * 10;
+        uint64_t tp10 = sp10 + 10;
+        bool upin = vbl + out <= sp10 << 2;
+        bool wpin = (tp10 << 2) + out <= vbr;
+        if (upin != wpin) {
+            *f = upin ? sp10 : tp10;
+            *e = k;
+            return;
+        }
+    }
+    uint64_t t = s + 1;
+    bool uin = vbl + out <= s << 2;
+    bool win = (t << 2) + out <= vbr;
+    *e = k;
+    if (uin != win) {
+        *f = uin ? s : t;
+        return;
+    }
+    // both are inside, take the closer one and the even one on a tie
+    int64_t cmp = (int64_t)(vb - ((s + t) << 1));
+    *f = cmp < 0 || (cmp == 0 && (s & 1) == 0) ? s : t;
+}
+/*
+    writes the shortest digits of a positive finite value to buffer and the decimal exponent to exponent
+    so that value ~= digits * 10^exponent, no other decimal with as few digits reads back as value or is closer to it
+    returns the number of digits
+    NOTE: you usually won't have to call this yourself
+*/
+int number_shortest(double value, char* buffer, int* exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased = (int)((bits >> 52) & 0x7ff);
+    uint64_t significand = bits & (((uint64_t)1 << 52) - 1);
+    uint64_t f;
+    int e = 0;
+    if (biased != 0) {
+        int shift = 1075 - biased;
+        uint64_t c = ((uint64_t)1 << 52) | significand;
+        // integers below 2^53 are their own shortest digits
+        if (shift > 0 && shift < 53 && (c >> shift) << shift == c) {
+            f = c >> shift;
+        } else {
+            number_schubfach_decimal(-shift, c, &f, &e);
+        }
+    } else {
+        number_schubfach_decimal(-1074, significand, &f, &e);
+    }
+    while (f % 10 == 0) {
+        f /= 10;
+        e += 1;
+    }
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* begin = number_format_u64(f, end);
+    int len = (int)(end - begin);
+    memcpy(buffer, begin, len);
+    *exponent = e;
+    return len;
+}
+/*
+    pushes the shortest decimal that reads back as exactly value, the closest one if there are several
+    plain notation for exponents in [-6, 21), otherwise scientific like 1.5e-7 or 1e+300
+    nan and infinities are pushed as nan, inf and -inf
+*/
+void string_push_f64(string *self, double value) {
+    if (isnan(value)) {
+        string_push_cstr(self, "nan");
+        return;
+    }
+    if (signbit(value)) {
+        string_push_char(self, '-');
+        value = -value;
+    }
+    if (isinf(value)) {
+        string_push_cstr(self, "inf");
+        return;
+    }
+    if (value == 0) {
+        string_push_char(self, '0');
+        return;
+    }
+
+    char digits[24];
+    int exponent;
+    int len = number_shortest(value, digits, &exponent);
+    // value == 0.digits * 10^point
+    int point = len + exponent;
+    char out[32];
+    size_t at = 0;
+    if (exponent >= 0 && point <= 21) {
+        memcpy(out, digits, len);
+        memset(out + len, '0', exponent);
+        at = point;
+    } else if (point > 0 && point <= 21) {
+        memcpy(out, digits, point);
+        out[point] = '.';
+        memcpy(out + point + 1, digits + point, len - point);
+        at = len + 1;
+    } else if (point > -6 && point <= 0) {
+        out[0] = '0';
+        out[1] = '.';
+        memset(out + 2, '0', -point);
+        memcpy(out + 2 - point, digits, len);
+        at = 2 - point + len;
+    } else {
+        out[at++] = digits[0];
+        if (len > 1) {
+            out[at++] = '.';
+            memcpy(out + at, digits + 1, len - 1);
+            at += len - 1;
+        }
+        int scientific = point - 1;
+        out[at++] = 'e';
+        out[at++] = scientific < 0 ? '-' : '+';
+        char* end = out + sizeof(out);
+        char* begin = number_format_u64((uint64_t)(scientific < 0 ? -scientific : scientific), end);
+        memmove(out + at, begin, end - begin);
+        at += end - begin;
+    }
+    string_push_bytes(self, out, at);
+}
+/*
+    parses an optionally signed decimal integer that takes up the whole view, no whitespace allowed
+    returns ERR_INVALID_FORMAT if it isn't one and ERR_OUT_OF_RANGE if it doesn't fit in an int64_t
+*/
+result_i64 str_parse_i64(str self) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < self.len && (self.ptr[i] == '-' || self.ptr[i] == '+')) {
+        negative = self.ptr[i] == '-';
+        i += 1;
+    }
+    if (i == self.len) {
+        return (result_i64){.err = ERR_INVALID_FORMAT};
+    }
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t value = 0;
+    for (; i < self.len; i++) {
+        unsigned digit = (unsigned char)self.ptr[i] - '0';
+        if (digit > 9) {
+            return (result_i64){.err = ERR_INVALID_FORMAT};
+        }
+        if (value > (limit - digit) / 10) {
+            return (result_i64){.err = ERR_OUT_OF_RANGE};
+        }
+        value = value * 10 + digit;
+    }
+    int64_t result = negative ? (int64_t)(0 - value) : (int64_t)value;
+    return (result_i64){.err = ERR_NONE, .value = result};
+}
+/*
+    eisel-lemire ("number parsing at a gigabyte per second" by daniel lemire), following go's strconv
+    converts w * 10^q to the nearest double with one or two 64 bit multiplies against NUMBER_POW10_128
+    returns false when the product is too close to a halfway point to decide or the result is subnormal or out of range
+    NOTE: you usually won't have to call this yourself
+*/
+bool number_eisel_lemire(uint64_t w, int q, double* out) {
+    if (w == 0) {
+        *out = 0;
+        return true;
+    }
+    if (q < NUMBER_POW10_128_MIN || q > 308) {
+        return false;
+    }
+    int clz = __builtin_clzll(w);
+    w <<= clz;
+    // floor(q * log2(10)) + 64 + the exponent bias
+    uint64_t exponent = (uint64_t)(((int64_t)217706 * q >> 16) + 64 + 1023 - clz);
+    const uint64_t* power = &NUMBER_POW10_128[2 * (q - NUMBER_POW10_128_MIN)];
+    __uint128_t product = (__uint128_t)w * power[0];
+    uint64_t high = (uint64_t)(product >> 64);
+    uint64_t low = (uint64_t)product;
+    // the low bits that decide rounding may carry from the second word, so bring it in
+    if ((high & 0x1ff) == 0x1ff && low + w < w) {
+        __uint128_t wider = (__uint128_t)w * power[1];
+        uint64_t merged_high = high;
+        uint64_t merged_low = low + (uint64_t)(wider >> 64);
+        if (merged_low < low) {
+            merged_high += 1;
+        }
+        if ((merged_high & 0x1ff) == 0x1ff && merged_low + 1 == 0 && (uint64_t)wider + w < w) {
+            return false;
+        }
+        high = merged_high;
+        low = merged_low;
+    }
+    uint64_t msb = high >> 63;
+    uint64_t mantissa = high >> (msb + 9);
+    exponent -= 1 ^ msb;
+    // exactly halfway between two doubles, can't tell which way ties to even from here
+    if (low == 0 && (high & 0x1ff) == 0 && (mantissa & 3) == 1) {
+        return false;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >> 53) {
+        mantissa >>= 1;
+        exponent += 1;
+    }
+    // 0 and below are subnormal, 0x7ff and above infinite
+    if (exponent - 1 >= 0x7ff - 1) {
+        return false;
+    }
+    uint64_t bits = exponent << 52 | (mantissa & (((uint64_t)1 << 52) - 1));
+    memcpy(out, &bits, sizeof(bits));
+    return true;
+}
+/*
+    parses a decimal floating point number that takes up the whole view, no whitespace allowed
+    accepts things like 1, -2.5, .5, 1e10, 6.02E+23, inf, infinity and nan (any case)
+    up to 19 significant digits with an exponent in [-22, 22] are converted exactly with a single multiply or divide,
+    anything else goes through eisel-lemire, and the rare inputs it can't decide (ties, subnormals, overflow)
+    fall back to strtod on a copy using the current locale's decimal point, so setlocale doesn't change the result
+    returns ERR_INVALID_FORMAT if it isn't a number and ERR_OUT_OF_RANGE if it overflows a double
+*/
+result_f64 str_parse_f64(str self) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < self.len && (self.ptr[i] == '-' || self.ptr[i] == '+')) {
+        negative = self.ptr[i] == '-';
+        i += 1;
+    }
+    str rest = str_slice(self, i, self.len);
+    if (str_equal_ignore_case(rest, str_from_cstr("inf")) || str_equal_ignore_case(rest, str_from_cstr("infinity"))) {
+        return (result_f64){.err = ERR_NONE, .value = negative ? -INFINITY : INFINITY};
+    }
+    if (str_equal_ignore_case(rest, str_from_cstr("nan"))) {
+        return (result_f64){.err = ERR_NONE, .value = negative ? -NAN : NAN};
+    }
+
+    // only the first 19 significant digits fit, truncated says whether any non zero digit was dropped after them
+    uint64_t mantissa = 0;
+    int digits = 0;
+    bool truncated = false;
+    int exponent = 0;
+    bool any = false;
+    for (; i < self.len && (unsigned)(self.ptr[i] - '0') <= 9; i++) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (self.ptr[i] - '0');
+            digits += mantissa != 0;
+        } else {
+            truncated |= self.ptr[i] != '0';
+            exponent += 1;
+        }
+    }
+    if (i < self.len && self.ptr[i] == '.') {
+        i += 1;
+        for (; i < self.len && (unsigned)(self.ptr[i] - '0') <= 9; i++) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (self.ptr[i] - '0');
+                digits += mantissa != 0;
+                exponent -= 1;
+            } else {
+                truncated |= self.ptr[i] != '0';
+            }
+        }
+    }
+    if (!any) {
+        return (result_f64){.err = ERR_INVALID_FORMAT};
+    }
+    if (i < self.len && (self.ptr[i] == 'e' || self.ptr[i] == 'E')) {
+        i += 1;
+        bool negative_exponent = false;
+        if (i < self.len && (self.ptr[i] == '-' || self.ptr[i] == '+')) {
+            negative_exponent = self.ptr[i] == '-';
+            i += 1;
+        }
+        if (i == self.len) {
+            return (result_f64){.err = ERR_INVALID_FORMAT};
+        }
+        int written = 0;
+        for (; i < self.len && (unsigned)(self.ptr[i] - '0') <= 9; i++) {
+            if (written < 100000) {
+                written = written * 10 + (self.ptr[i] - '0');
+            }
+        }
+        exponent += negative_exponent ? -written : written;
+    }
+    if (i != self.len) {
+        return (result_f64){.err = ERR_INVALID_FORMAT};
+    }
+
+    // clinger's fast path, both the mantissa and 10^exponent are exact doubles so one rounding gives the right answer
+    if (!truncated && mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / NUMBER_POW10_F64[-exponent] : value * NUMBER_POW10_F64[exponent];
+        return (result_f64){.err = ERR_NONE, .value = negative ? -value : value};
+    }
+
+    double value;
+    if (number_eisel_lemire(mantissa, exponent, &value)) {
+        // with digits dropped the value lies between mantissa and mantissa + 1, both ends have to agree
+        double upper;
+        if (!truncated || (number_eisel_lemire(mantissa + 1, exponent, &upper) && upper == value)) {
+            return (result_f64){.err = ERR_NONE, .value = negative ? -value : value};
+        }
+    }
+
+    // strtod reads the decimal point from LC_NUMERIC, so swap the '.' for the current locale's one
+    const char* point = localeconv()->decimal_point;
+    size_t point_len = strlen(point);
+    char small[64];
+    size_t cap = self.len + point_len + 1;
+    char* copy = cap <= sizeof(small) ? small : (char*)malloc(cap);
+    size_t len = 0;
+    for (size_t j = 0; j < self.len; j++) {
+        if (self.ptr[j] == '.') {
+            memcpy(copy + len, point, point_len);
+            len += point_len;
+        } else {
+            copy[len++] = self.ptr[j];
+        }
+    }
+    copy[len] = 0;
+    char* end;
+    errno = 0;
+    value = strtod(copy, &end);
+    bool overflow = errno == ERANGE && isinf(value);
+    bool whole = end == copy + len;
+    if (copy != small) {
+        free(copy);
+    }
+    if (!whole) {
+        return (result_f64){.err = ERR_INVALID_FORMAT};
+    }
+    if (overflow) {
+        return (result_f64){.err = ERR_OUT_OF_RANGE, .value = value};
+    }
+    return (result_f64){.err = ERR_NONE, .value = value};
+}
+
+
+
+/* ################# ENCODING ################# */
+
+
+
+// which 64 chars base64 uses, BASE64_URL swaps "+/" for "-_" and leaves out the '=' padding
+typedef enum {
+    BASE64_STANDARD,
+    BASE64_URL,
+} base64_alphabet;
+
+const char BASE64_STANDARD_CHARS[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char BASE64_URL_CHARS[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const char HEX_CHARS[17] = "0123456789abcdef";
+
+/* returns the number of chars base64_encode writes for len bytes */
+size_t base64_encoded_len(size_t len, base64_alphabet alphabet) {
+    if (alphabet == BASE64_URL) {
+        return len / 3 * 4 + (len % 3 ? len % 3 + 1 : 0);
+    }
+    return (len + 2) / 3 * 4;
+}
+/* returns the most bytes base64_decode can write for len chars */
+size_t base64_decoded_max(size_t len) {
+    return len / 4 * 3 + 2;
+}
+/* returns the 6 bit value of c or -1 if it isn't in the alphabet */
+int base64_value(char c, base64_alphabet alphabet) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == (alphabet == BASE64_URL ? '-' : '+')) {
+        return 62;
+    }
+    if (c == (alphabet == BASE64_URL ? '_' : '/')) {
+        return 63;
+    }
+    return -1;
+}
+/*
+    writes data as base64 to dst, which needs room for base64_encoded_len chars
+    with avx2, 24 bytes become 32 chars per step ("faster base64 encoding and decoding using avx2 instructions" by mula and lemire)
+    returns the number of chars written
+*/
+size_t base64_encode(char* dst, str data, base64_alphabet alphabet) {
+    const char* chars = alphabet == BASE64_URL ? BASE64_URL_CHARS : BASE64_STANDARD_CHARS;
+    const unsigned char* src = (const unsigned char*)data.ptr;
+    char* out = dst;
+    size_t i = 0;
+#if defined(__AVX2__)
+    // offsets from each 6 bit value to its char, picked by how far the value is past 51
+    const __m256i shift_lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, chars[62] - 62, chars[63] - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, chars[62] - 62, chars[63] - 63, 'A', 0, 0
+    );
+    // each lane takes 12 bytes and spreads every 3 of them over 4, as b1 b0 b2 b1
+    const __m256i spread = _mm256_setr_epi8(
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+    );
+    // the second lane loads 16 bytes from 12 in, so 28 bytes have to be readable
+    for (; i + 28 <= data.len; i += 24) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i))),
+            _mm_loadu_si128((const __m128i*)(src + i + 12)), 1
+        );
+        in = _mm256_shuffle_epi8(in, spread);
+        // move the four 6 bit fields of every 32 bits into their own byte
+        __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i values = _mm256_or_si256(ac, bd);
+        __m256i shift = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+        __m256i below_26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), values);
+        shift = _mm256_or_si256(shift, _mm256_and_si256(below_26, _mm256_set1_epi8(13)));
+        __m256i encoded = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, shift), values);
+        _mm256_storeu_si256((__m256i*)out, encoded);
+        out += 32;
+    }
+#endif
+    for (; i + 3 <= data.len; i += 3) {
+        uint32_t triple = (uint32_t)src[i] << 16 | (uint32_t)src[i + 1] << 8 | src[i + 2];
+        out[0] = chars[triple >> 18];
+        out[1] = chars[(triple >> 12) & 63];
+        out[2] = chars[(triple >> 6) & 63];
+        out[3] = chars[triple & 63];
+        out += 4;
+    }
+    size_t rest = data.len - i;
+    if (rest > 0) {
+        uint32_t triple = (uint32_t)src[i] << 16 | (rest == 2 ? (uint32_t)src[i + 1] << 8 : 0);
+        *out++ = chars[triple >> 18];
+        *out++ = chars[(triple >> 12) & 63];
+        if (rest == 2) {
+            *out++ = chars[(triple >> 6) & 63];
+        }
+        if (alphabet != BASE64_URL) {
+            if (rest == 1) {
+                *out++ = '=';
+            }
+            *out++ = '=';
+        }
+    }
+    return out - dst;
+}
+/*
+    decodes base64 text to dst, which needs room for base64_decoded_max(text.len) bytes
+    the '=' padding is optional, with avx2 32 chars are checked and decoded per step
+    returns the number of bytes written
+    returns ERR_INVALID_FORMAT if text has a char outside the alphabet or a length no encoding produces
+*/
+result_size_t base64_decode(char* dst, str text, base64_alphabet alphabet) {
+    size_t len = text.len;
+    if (len > 0 && len % 4 == 0 && text.ptr[len - 1] == '=') {
+        len -= text.ptr[len - 2] == '=' ? 2 : 1;
+    }
+    if (len % 4 == 1) {
+        return (result_size_t){.err = ERR_INVALID_FORMAT};
+    }
+    const char* src = text.ptr;
+    unsigned char* out = (unsigned char*)dst;
+    size_t i = 0;
+#if defined(__AVX2__)
+    if (len >= 32) {
+        const char* chars = alphabet == BASE64_URL ? BASE64_URL_CHARS : BASE64_STANDARD_CHARS;
+        charset valid = charset_from(str_from_bytes(chars, 64));
+        // what to add to a char to get its value, by its high nibble, char 63 is the only one that needs more than that
+        const __m256i roll_lut = _mm256_setr_epi8(
+            0, 0, 62 - chars[62], 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 62 - chars[62], 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+        );
+        const __m256i pack = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+        );
+        for (; i + 32 <= len; i += 32) {
+            if (charset_block_mask(&valid, src + i) != ~(uint32_t)0) {
+                return (result_size_t){.err = ERR_INVALID_FORMAT};
+            }
+            __m256i in = _mm256_loadu_si256((const __m256i*)(src + i));
+            __m256i high = _mm256_and_si256(_mm256_srli_epi16(in, 4), _mm256_set1_epi8(0x0f));
+            __m256i roll = _mm256_shuffle_epi8(roll_lut, high);
+            roll = _mm256_blendv_epi8(roll, _mm256_set1_epi8((char)(63 - chars[63])), _mm256_cmpeq_epi8(in, _mm256_set1_epi8(chars[63])));
+            __m256i values = _mm256_add_epi8(in, roll);
+            // join the four 6 bit values of every 32 bits into 24 bits, then drop the empty byte
+            __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+            __m256i joined = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+            joined = _mm256_shuffle_epi8(joined, pack);
+            joined = _mm256_permutevar8x32_epi32(joined, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+            _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(joined));
+            _mm_storel_epi64((__m128i*)(out + 16), _mm256_extracti128_si256(joined, 1));
+            out += 24;
+        }
+    }
+#endif
+    for (; i + 2 <= len; i += 4) {
+        size_t count = len - i < 4 ? len - i : 4;
+        uint32_t quad = 0;
+        for (size_t j = 0; j < 4; j++) {
+            int value = j < count ? base64_value(src[i + j], alphabet) : 0;
+            if (value < 0) {
+                return (result_size_t){.err = ERR_INVALID_FORMAT};
+            }
+            quad = quad << 6 | (uint32_t)value;
+        }
+        *out++ = (unsigned char)(quad >> 16);
+        if (count > 2) {
+            *out++ = (unsigned char)(quad >> 8);
+        }
+        if (count > 3) {
+            *out++ = (unsigned char)quad;
+        }
+    }
+    return (result_size_t){.err = ERR_NONE, .value = (size_t)(out - (unsigned char*)dst)};
+}
+/*
+    writes data as lowercase hex to dst, which needs room for 2 * data.len chars
+    returns the number of chars written
+*/
+size_t hex_encode(char* dst, str data) {
+    const unsigned char* src = (const unsigned char*)data.ptr;
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i digits = _mm256_setr_epi8(
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+    );
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    for (; i + 32 <= data.len; i += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(in, 4), low_nibbles));
+        __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(in, low_nibbles));
+        // unpack works per lane, so the halves come out as bytes 0..7 16..23 and 8..15 24..31
+        __m256i first = _mm256_unpacklo_epi8(high, low);
+        __m256i second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256((__m256i*)(dst + i * 2), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + i * 2 + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+#endif
+    for (; i < data.len; i++) {
+        dst[i * 2] = HEX_CHARS[src[i] >> 4];
+        dst[i * 2 + 1] = HEX_CHARS[src[i] & 0x0f];
+    }
+    return data.len * 2;
+}
+/* returns the value of hex digit c (either case) or -1 if it isn't one */
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+        return (c | 0x20) - 'a' + 10;
+    }
+    return -1;
+}
+/*
+    decodes hex text (either case) to dst, which needs room for text.len / 2 bytes
+    returns the number of bytes written
+    returns ERR_INVALID_FORMAT for an odd length or a char that isn't a hex digit
+*/
+result_size_t hex_decode(char* dst, str text) {
+    if (text.len % 2) {
+        return (result_size_t){.err = ERR_INVALID_FORMAT};
+    }
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= text.len; i += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(text.ptr + i));
+        __m256i digit = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+        __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i letter = _mm256_sub_epi8(_mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+        if (~_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter))) {
+            return (result_size_t){.err = ERR_INVALID_FORMAT};
+        }
+        __m256i values = _mm256_blendv_epi8(_mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, is_digit);
+        // high nibble * 16 + low nibble, then pack the 16 bit results down to bytes
+        __m256i joined = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+        joined = _mm256_packus_epi16(joined, joined);
+        joined = _mm256_permute4x64_epi64(joined, 0x08);
+        _mm_storeu_si128((__m128i*)(dst + i / 2), _mm256_castsi256_si128(joined));
+    }
+#endif
+    for (; i < text.len; i += 2) {
+        int high = hex_value(text.ptr[i]);
+        int low = hex_value(text.ptr[i + 1]);
+        if (high < 0 || low < 0) {
+            return (result_size_t){.err = ERR_INVALID_FORMAT};
+        }
+        dst[i / 2] = (char)(high << 4 | low);
+    }
+    return (result_size_t){.err = ERR_NONE, .value = text.len / 2};
+}
+/*
+    makes room for n more chars and returns where they start, the len is left alone
+    source is moved along with the buffer if it points into the string
+    NOTE: you usually won't have to call this yourself
+*/
+char* string_reserve_tail(string *self, str* source, size_t n) {
+    char* data = string_data(self);
+    size_t len = string_len(self);
+    if (source->ptr >= data && source->ptr < data + len) {
+        size_t offset = source->ptr - data;
+        string_reserve(self, n);
+        source->ptr = string_data(self) + offset;
+    } else {
+        string_reserve(self, n);
+    }
+    return string_data(self) + len;
+}
+/* same as string_reserve_tail for a dyn_char */
+char* dyn_char_reserve_tail(dyn_char* self, str* source, size_t n) {
+    if (self->cap - self->len < n) {
+        if (source->ptr >= self->buf && source->ptr < self->buf + self->len) {
+            size_t offset = source->ptr - self->buf;
+            dyn_resize_with_add_char(self, n);
+            source->ptr = self->buf + offset;
+        } else {
+            dyn_resize_with_add_char(self, n);
+        }
+    }
+    return self->buf + self->len;
+}
+/* pushes data as base64, reserving the exact room once */
+void string_push_base64(string *self, str data, base64_alphabet alphabet) {
+    char* out = string_reserve_tail(self, &data, base64_encoded_len(data.len, alphabet));
+    string_set_len(self, string_len(self) + base64_encode(out, data, alphabet));
+}
+/* pushes data as lowercase hex, reserving the exact room once */
+void string_push_hex(string *self, str data) {
+    char* out = string_reserve_tail(self, &data, data.len * 2);
+    string_set_len(self, string_len(self) + hex_encode(out, data));
+}
+/*
+    decodes base64 text and pushes the bytes, see base64_decode
+    returns the number of bytes pushed, on error the string is left as it was
+*/
+result_size_t string_push_base64_decoded(string *self, str text, base64_alphabet alphabet) {
+    size_t len = string_len(self);
+    char* out = string_reserve_tail(self, &text, base64_decoded_max(text.len));
+    result_size_t decoded = base64_decode(out, text, alphabet);
+    string_set_len(self, len + (decoded.err == ERR_NONE ? decoded.value : 0));
+    return decoded;
+}
+/*
+    decodes hex text and pushes the bytes, see hex_decode
+    returns the number of bytes pushed, on error the string is left as it was
+*/
+result_size_t string_push_hex_decoded(string *self, str text) {
+    size_t len = string_len(self);
+    char* out = string_reserve_tail(self, &text, text.len / 2);
+    result_size_t decoded = hex_decode(out, text);
+    string_set_len(self, len + (decoded.err == ERR_NONE ? decoded.value : 0));
+    return decoded;
+}
+/* same as string_push_base64 for a dyn_char, nothing is null terminated */
+void dyn_push_base64_char(dyn_char* self, str data, base64_alphabet alphabet) {
+    char* out = dyn_char_reserve_tail(self, &data, base64_encoded_len(data.len, alphabet));
+    self->len += base64_encode(out, data, alphabet);
+}
+/* same as string_push_hex for a dyn_char */
+void dyn_push_hex_char(dyn_char* self, str data) {
+    char* out = dyn_char_reserve_tail(self, &data, data.len * 2);
+    self->len += hex_encode(out, data);
+}
+/* same as string_push_base64_decoded for a dyn_char */
+result_size_t dyn_push_base64_decoded_char(dyn_char* self, str text, base64_alphabet alphabet) {
+    char* out = dyn_char_reserve_tail(self, &text, base64_decoded_max(text.len));
+    result_size_t decoded = base64_decode(out, text, alphabet);
+    if (decoded.err == ERR_NONE) {
+        self->len += decoded.value;
+    }
+    return decoded;
+}
+/* same as string_push_hex_decoded for a dyn_char */
+result_size_t dyn_push_hex_decoded_char(dyn_char* self, str text) {
+    char* out = dyn_char_reserve_tail(self, &text, text.len / 2);
+    result_size_t decoded = hex_decode(out, text);
+    if (decoded.err == ERR_NONE) {
+        self->len += decoded.value;
+    }
+    return decoded;
+}
+
+
+
+/* ################# EDIT DISTANCE ################# */
+
+
+
+// levenshtein distance with the bit parallel algorithm of myers ("a fast bit-vector algorithm for approximate
+// string matching based on dynamic programming") in the formulation of hyyro, one column of the dp matrix is
+// kept as bit vectors of +1/-1 vertical deltas and a whole column is computed per text byte
+
+// bound that never cuts a distance short, for when the exact distance is wanted
+#define EDIT_UNBOUNDED (SIZE_MAX - 1)
+
+// a pattern's match masks, bit i of .peq[byte * .words + i / 64] is set if pattern byte i is byte
+// build it once with edit_pattern_init to compare one pattern against many texts
+typedef struct {
+    size_t len;
+    size_t words;
+    uint64_t* peq;
+} edit_pattern;
+
+/*
+    builds the match masks of pattern
+
+    NOTE: call edit_pattern_deinit to free
+*/
+edit_pattern edit_pattern_init(str pattern) {
+    size_t words = pattern.len ? (pattern.len + 63) / 64 : 1;
+    edit_pattern self = {
+        .len = pattern.len,
+        .words = words,
+        .peq = (uint64_t*)calloc(256 * words, sizeof(uint64_t)),
+    };
+    for (size_t i = 0; i < pattern.len; i++) {
+        self.peq[(unsigned char)pattern.ptr[i] * words + i / 64] |= (uint64_t)1 << (i % 64);
+    }
+    return self;
+}
+void edit_pattern_deinit(edit_pattern* self) {
+    free(self->peq);
+    self->peq = NULL;
+    self->len = 0;
+}
+/*
+    distance for patterns of 1 to 64 bytes, one word per text byte
+    gives up once the distance can't end up at or below max and returns max + 1
+    NOTE: you usually won't have to call this yourself
+*/
+size_t edit_distance_word(const uint64_t* peq, size_t len, str text, size_t max) {
+    uint64_t vp = len == 64 ? ~(uint64_t)0 : ((uint64_t)1 << len) - 1;
+    uint64_t vn = 0;
+    uint64_t last = (uint64_t)1 << (len - 1);
+    size_t score = len;
+    for (size_t j = 0; j < text.len; j++) {
+        uint64_t eq = peq[(unsigned char)text.ptr[j]];
+        uint64_t d0 = (((eq & vp) + vp) ^ vp) | eq | vn;
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+        score += (hp & last) != 0;
+        score -= (hn & last) != 0;
+        // every remaining text byte lowers the distance by at most 1
+        if (score > max && score - max > text.len - j - 1) {
+            return max + 1;
+        }
+        hp = (hp << 1) | 1;
+        hn = hn << 1;
+        vp = hn | ~(d0 | hp);
+        vn = hp & d0;
+    }
+    return score;
+}
+/*
+    distance for patterns longer than 64 bytes, the column is split into words and
+    the horizontal delta leaving the top of each word is carried into the next one
+    NOTE: you usually won't have to call this yourself
+*/
+size_t edit_distance_blocks(const uint64_t* peq, size_t words, size_t len, str text, size_t max) {
+    uint64_t* vp = (uint64_t*)malloc(2 * words * sizeof(uint64_t));
+    uint64_t* vn = vp + words;
+    for (size_t w = 0; w < words; w++) {
+        vp[w] = ~(uint64_t)0;
+        vn[w] = 0;
+    }
+    uint64_t last = (uint64_t)1 << ((len - 1) % 64);
+    size_t score = len;
+    for (size_t j = 0; j < text.len; j++) {
+        const uint64_t* eqs = peq + (unsigned char)text.ptr[j] * words;
+        // the top row of the matrix is 0, 1, 2, ... so it always steps by +1
+        uint64_t hp_carry = 1;
+        uint64_t hn_carry = 0;
+        for (size_t w = 0; w < words; w++) {
+            uint64_t eq = eqs[w] | hn_carry;
+            uint64_t d0 = (((eq & vp[w]) + vp[w]) ^ vp[w]) | eq | vn[w];
+            uint64_t hp = vn[w] | ~(d0 | vp[w]);
+            uint64_t hn = d0 & vp[w];
+            uint64_t hp_out = w + 1 < words ? hp >> 63 : (hp & last) != 0;
+            uint64_t hn_out = w + 1 < words ? hn >> 63 : (hn & last) != 0;
+            hp = (hp << 1) | hp_carry;
+            hn = (hn << 1) | hn_carry;
+            vp[w] = hn | ~(d0 | hp);
+            vn[w] = hp & d0;
+            hp_carry = hp_out;
+            hn_carry = hn_out;
+        }
+        score += hp_carry;
+        score -= hn_carry;
+        if (score > max && score - max > text.len - j - 1) {
+            score = max + 1;
+            break;
+        }
+    }
+    free(vp);
+    return score;
+}
+/*
+    levenshtein distance from the pattern to text, gives up early and returns max + 1 once it must exceed max
+    pass EDIT_UNBOUNDED as max for the exact distance
+*/
+size_t edit_pattern_distance(const edit_pattern* self, str text, size_t max) {
+    size_t gap = self->len > text.len ? self->len - text.len : text.len - self->len;
+    if (gap > max) {
+        return max + 1;
+    }
+    if (self->len == 0) {
+        return text.len;
+    }
+    if (self->words == 1) {
+        return edit_distance_word(self->peq, self->len, text, max);
+    }
+    return edit_distance_blocks(self->peq, self->words, self->len, text, max);
+}
+/*
+    levenshtein distance (insertions, deletions and substitutions of single bytes) bounded by max
+    returns max + 1 if the distance is greater than max, which lets far apart strings stop early
+*/
+size_t str_levenshtein_bounded(str one, str two, size_t max) {
+    // a shared prefix or suffix never changes the distance
+    while (one.len && two.len && one.ptr[0] == two.ptr[0]) {
+        one = str_slice(one, 1, one.len);
+        two = str_slice(two, 1, two.len);
+    }
+    while (one.len && two.len && one.ptr[one.len - 1] == two.ptr[two.len - 1]) {
+        one.len -= 1;
+        two.len -= 1;
+    }
+    // the shorter one is the pattern so it takes fewer words
+    if (one.len > two.len) {
+        str swap = one;
+        one = two;
+        two = swap;
+    }
+    size_t gap = two.len - one.len;
+    if (gap > max) {
+        return max + 1;
+    }
+    if (one.len == 0) {
+        return two.len;
+    }
+    if (one.len <= 64) {
+        uint64_t peq[256] = {0};
+        for (size_t i = 0; i < one.len; i++) {
+            peq[(unsigned char)one.ptr[i]] |= (uint64_t)1 << i;
+        }
+        return edit_distance_word(peq, one.len, two, max);
+    }
+    edit_pattern pattern = edit_pattern_init(one);
+    size_t distance = edit_pattern_distance(&pattern, two, max);
+    edit_pattern_deinit(&pattern);
+    return distance;
+}
+/* levenshtein distance, the number of single byte insertions, deletions and substitutions to turn one into two */
+size_t str_levenshtein(str one, str two) {
+    return str_levenshtein_bounded(one, two, EDIT_UNBOUNDED);
+}
+/*
+    optimal string alignment dp, used by str_damerau past 64 bytes
+    NOTE: you usually won't have to call this yourself
+*/
+size_t edit_distance_osa_dp(str one, str two) {
+    size_t* rows = (size_t*)malloc(3 * (two.len + 1) * sizeof(size_t));
+    size_t* before = rows;
+    size_t* above = rows + two.len + 1;
+    size_t* row = rows + 2 * (two.len + 1);
+    for (size_t j = 0; j <= two.len; j++) {
+        above[j] = j;
+    }
+    for (size_t i = 1; i <= one.len; i++) {
+        row[0] = i;
+        for (size_t j = 1; j <= two.len; j++) {
+            size_t cost = one.ptr[i - 1] != two.ptr[j - 1];
+            size_t best = above[j - 1] + cost;
+            if (above[j] + 1 < best) {
+                best = above[j] + 1;
+            }
+            if (row[j - 1] + 1 < best) {
+                best = row[j - 1] + 1;
+            }
+            if (i > 1 && j > 1 && one.ptr[i - 1] == two.ptr[j - 2] && one.ptr[i - 2] == two.ptr[j - 1] && before[j - 2] + 1 < best) {
+                best = before[j - 2] + 1;
+            }
+            row[j] = best;
+        }
+        size_t* spare = before;
+        before = above;
+        above = row;
+        row = spare;
+    }
+    size_t distance = above[two.len];
+    free(rows);
+    return distance;
+}
+/*
+    damerau distance in its optimal string alignment form: like levenshtein but swapping two adjacent bytes costs 1,
+    as long as no part of the string is edited twice ("ca" -> "abc" is 3, not 2)
+    bit parallel (hyyro's extension of myers) when the shorter string is up to 64 bytes, a dp otherwise
+*/
+size_t str_damerau(str one, str two) {
+    while (one.len && two.len && one.ptr[0] == two.ptr[0]) {
+        one = str_slice(one, 1, one.len);
+        two = str_slice(two, 1, two.len);
+    }
+    while (one.len && two.len && one.ptr[one.len - 1] == two.ptr[two.len - 1]) {
+        one.len -= 1;
+        two.len -= 1;
+    }
+    if (one.len > two.len) {
+        str swap = one;
+        one = two;
+        two = swap;
+    }
+    if (one.len == 0) {
+        return two.len;
+    }
+    if (one.len > 64) {
+        return edit_distance_osa_dp(one, two);
+    }
+    uint64_t peq[256] = {0};
+    for (size_t i = 0; i < one.len; i++) {
+        peq[(unsigned char)one.ptr[i]] |= (uint64_t)1 << i;
+    }
+    uint64_t vp = one.len == 64 ? ~(uint64_t)0 : ((uint64_t)1 << one.len) - 1;
+    uint64_t vn = 0;
+    uint64_t d0 = 0;
+    uint64_t eq_before = 0;
+    uint64_t last = (uint64_t)1 << (one.len - 1);
+    size_t score = one.len;
+    for (size_t j = 0; j < two.len; j++) {
+        uint64_t eq = peq[(unsigned char)two.ptr[j]];
+        // a transposition is a diagonal step from two rows and columns back
+        uint64_t transposed = (((~d0) & eq) << 1) & eq_before;
+        d0 = (((eq & vp) + vp) ^ vp) | eq | vn | transposed;
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+        score += (hp & last) != 0;
+        score -= (hn & last) != 0;
+        hp = (hp << 1) | 1;
+        hn = hn << 1;
+        vp = hn | ~(d0 | hp);
+        vn = hp & d0;
+        eq_before = eq;
+    }
+    return score;
+}
+/*
+    levenshtein distance from query to every candidate, the query's masks are built once for the whole batch
+    distances above max come back as max + 1, pass EDIT_UNBOUNDED for exact distances
+
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t str_levenshtein_batch(str query, dyn_str* candidates, size_t max) {
+    dyn_size_t distances = dyn_init_with_cap_size_t(candidates->len + 1);
+    edit_pattern pattern = edit_pattern_init(query);
+    for (size_t i = 0; i < candidates->len; i++) {
+        dyn_push_size_t(&distances, edit_pattern_distance(&pattern, candidates->buf[i], max));
+    }
+    edit_pattern_deinit(&pattern);
+    return distances;
+}
+/*
+    finds the candidate closest to query by levenshtein distance, the first one wins a tie
+    the bound shrinks to the best distance so far so most candidates stop early
+    returns its index as an option, .ok = false if none is within max
+*/
+option_size_t str_closest(str query, dyn_str* candidates, size_t max) {
+    option_size_t best = {.ok = false};
+    edit_pattern pattern = edit_pattern_init(query);
+    for (size_t i = 0; i < candidates->len; i++) {
+        size_t distance = edit_pattern_distance(&pattern, candidates->buf[i], max);
+        if (distance <= max) {
+            best = (option_size_t){.ok = true, .value = i};
+            if (distance == 0) {
+                break;
+            }
+            max = distance - 1;
+        }
+    }
+    edit_pattern_deinit(&pattern);
+    return best;
+}
+
+
+
+/* ################# MAP ################# */
+
+
+
+#define gen_map(K, V, typenames)\
+typedef struct {\
+    K key;\
+    V value;\
+    bool active;\
+} map_entry_##typenames;\
+gen_dyn_with_deps(map_entry_##typenames, map_entry_##typenames);\
+typedef struct {\
+    dyn_map_entry_##typenames entries;\
+    size_t active_count;\
+    size_t (*hash)(K);\
+    bool (*key_compare)(K, K);\
+} map_##typenames;\
+/*
+    allocates a dynamic array with a starting capacity of 97. check readme for why specifically 97
+    NOTE: call map_deinit to free after use
+*/\
+map_##typenames map_init_##typenames(size_t hash(K), bool key_compare(K, K)) {\
+    return (map_##typenames){\
+        .entries = dyn_init_with_cap_map_entry_##typenames(97),\
+        .active_count = 0,\
+        .hash = hash,\
+        .key_compare = key_compare,\
+    };\
+}\
+void map_deinit_##typenames(map_##typenames *self) {\
+    dyn_deinit_map_entry_##typenames(&self->entries);\
+}\
+/*
+    map_resize creates a new map and inserts the previous entries to the new one
+
+    NOTE: old map is freed during this function, careful of dangling pointers
+*/\
+bool map_insert_##typenames(map_##typenames *self, K key, V value);\
+void map_resize_##typenames(map_##typenames *self) {\
+    map_##typenames new_map = {\
+        .entries = dyn_init_with_cap_map_entry_##typenames(self->entries.cap * 2 + 1),\
+        .active_count = 0,\
+    };\
+    for (size_t i = 0; i < self->entries.cap; i++) {\
+        if (self->entries.buf[i].active) {\
+            map_insert_##typenames(&new_map, self->entries.buf[i].key, self->entries.buf[i].value);\
+        }\
+    }\
+\
+    map_deinit_##typenames(self);\
+    *self = new_map;\
+}\
+/*
+    returns false if key isn't unqiue
+*/\
+bool map_insert_##typenames(map_##typenames *self, K key, V value) {\
+    if (self->active_count >= self->entries.cap) {\
+        map_resize_##typenames(self);\
+    }\
+    size_t index = self->hash(key) % self->entries.cap;\
+    while (self->entries.buf[index].active) {\
+        if (self->key_compare(self->entries.buf[index].key, key)) {\
+            return false;\
+        }\
+        index = (index + 1) % self->entries.cap;\
+    }\
+    self->entries.buf[index].active = true;\
+    self->entries.buf[index].key = key;\
+    self->entries.buf[index].value = value;\
+    self->active_count += 1;\
+    return true;\
+}\
+/*
+    get entry by key
+    returns an option to the entry
+ */\
+option_map_entry_##typenames map_get_##typenames(map_##typenames *self, K key) {\
+    size_t index = self->hash(key) % self->entries.cap;\
+    for (size_t i = 0; i < self->entries.cap; i++) {\
+        if (!self->entries.buf[index].active) {\
+            break;\
+        }\
+        if (self->key_compare(self->entries.buf[index].key, key)) {\
+            break;\
+        } \
+        index = (index + 1) % self->entries.cap;\
+    }\
+    if (self->entries.buf[index].active && self->key_compare(self->entries.buf[index].key, key)) {\
+        return (option_map_entry_##typenames){\
+            .ok = true,\
+            .value = self->entries.buf[index],\
+        };\
+    }\
+    return (option_map_entry_##typenames){\
+        .ok = false,\
+    };\
+}\
+bool map_update_##typenames(map_##typenames *self, K key, V value) {\
+    size_t index = self->hash(key) % self->entries.cap;\
+    bool found = false;\
+    while (self->entries.buf[index].active) {\
+        if (self->key_compare(self->entries.buf[index].key, key)) {\
+            found = true;\
+            break;\
+        }\
+        index = (index + 1) % self->entries.cap;\
+    }\
+    if (!found) {\
+        return false;\
+    }\
+\
+    self->entries.buf[index].value = value;\
+    return true;\
+}\
+bool map_remove_##typenames(map_##typenames *self, K key) {\
+    size_t index = self->hash(key) % self->entries.cap;\
+    bool found = false;\
+    while (self->entries.buf[index].active) {\
+        if (self->key_compare(self->entries.buf[index].key, key)) {\
+            found = true;\
+            break;\
+        }\
+        index = (index + 1) % self->entries.cap;\
+    }\
+    if (!found) {\
+        return false;\
+    }\
+    self->entries.buf[index].active = false;\
+    self->active_count -= 1;\
+    return true;\
+}\
+
+// little macro to iterate over the active entries in a map
+#define map_iter(entry, iter, map, codeblock)\
+for (size_t iter = 0; iter < map.entries.cap; iter++) {\
+    typeof(map.entries.buf[0]) entry = map.entries.buf[iter];\
+    if (entry.active) {\
+        codeblock\
+    }\
+}
+
+// a hashing function for string keys
+size_t hash_djb2(char* str) {
+    size_t hash = 5381;
+    for (; *str; str++) {
+        hash = ((hash << 5) + hash) + *str;
+    }
+    return hash;
+}
+
+// string equal function that just returns if two strings are the same
+// this is in the header for convenience when using a map with char* keys
+bool str_equal(char* one, char* two) {
+    return strcmp(one, two) == 0;
+}
+
+// see if two numbers of the same type are equal
+// this is in the header for convenience when using a map with number keys
+// might seem dumb but since map needs a function to compare generic types, this is needed
+#define gen_num_equal(T, typename)\
+bool num_equal_##typename(T one, T two) {\
+    return one == two;\
+}\
+
+
+
+/* ################# ADAPTIVE RADIX TREE ################# */
+
+
+
+// adaptive radix tree ("the adaptive radix tree: artful indexing for main-memory databases" by leis et al.)
+// keys are byte strings, every node branches on one byte and picks the smallest of 4 layouts that fits its children
+// runs of bytes with no branch are stored once in .prefix (path compression)
+// a key that ends at a node keeps its value in .leaf, so a key can be a prefix of another without a terminator byte
+#define ART_NODE4 0
+#define ART_NODE16 1
+#define ART_NODE48 2
+#define ART_NODE256 3
+
+typedef struct {
+    uint8_t kind;
+    uint16_t count;
+    uint32_t prefix_len;
+    unsigned char* prefix;
+    void* leaf;
+} art_node;
+
+// .keys are kept sorted so walks come out in key order
+typedef struct {
+    art_node base;
+    unsigned char keys[4];
+    art_node* children[4];
+} art_node4;
+
+typedef struct {
+    art_node base;
+    unsigned char keys[16];
+    art_node* children[16];
+} art_node16;
+
+// .index[byte] is 1 + the slot of the child for byte, 0 if there is none
+typedef struct {
+    art_node base;
+    unsigned char index[256];
+    art_node* children[48];
+} art_node48;
+
+typedef struct {
+    art_node base;
+    art_node* children[256];
+} art_node256;
+
+/*
+    allocates an empty node of kind
+    NOTE: you usually won't have to call this yourself
+*/
+art_node* art_node_alloc(uint8_t kind) {
+    size_t sizes[4] = {sizeof(art_node4), sizeof(art_node16), sizeof(art_node48), sizeof(art_node256)};
+    art_node* node = (art_node*)calloc(1, sizes[kind]);
+    node->kind = kind;
+    return node;
+}
+/*
+    replaces the node's compressed path with a copy of len bytes at bytes
+    NOTE: you usually won't have to call this yourself
+*/
+void art_set_prefix(art_node* node, const unsigned char* bytes, size_t len) {
+    unsigned char* prefix = len ? (unsigned char*)malloc(len) : NULL;
+    if (len) {
+        memcpy(prefix, bytes, len);
+    }
+    free(node->prefix);
+    node->prefix = prefix;
+    node->prefix_len = (uint32_t)len;
+}
+/*
+    returns the slot holding the child for byte or NULL if there is none
+    node16 compares all 16 keys at once with sse2
+    NOTE: you usually won't have to call this yourself
+*/
+art_node** art_find_child(art_node* node, unsigned char byte) {
+    switch (node->kind) {
+    case ART_NODE4: {
+        art_node4* n = (art_node4*)node;
+        for (size_t i = 0; i < node->count; i++) {
+            if (n->keys[i] == byte) {
+                return &n->children[i];
+            }
+        }
+        return NULL;
+    }
+    case ART_NODE16: {
+        art_node16* n = (art_node16*)node;
+#if defined(__SSE2__)
+        __m128i hits = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128((const __m128i*)n->keys));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hits) & ((1u << node->count) - 1);
+        return mask ? &n->children[__builtin_ctz(mask)] : NULL;
+#else
+        for (size_t i = 0; i < node->count; i++) {
+            if (n->keys[i] == byte) {
+                return &n->children[i];
+            }
+        }
+        return NULL;
+#endif
+    }
+    case ART_NODE48: {
+        art_node48* n = (art_node48*)node;
+        return n->index[byte] ? &n->children[n->index[byte] - 1] : NULL;
+    }
+    default: {
+        art_node256* n = (art_node256*)node;
+        return n->children[byte] ? &n->children[byte] : NULL;
+    }
+    }
+}
+/*
+    moves the header of node to a new node of kind, the children are copied by the caller
+    NOTE: you usually won't have to call this yourself
+*/
+art_node* art_node_regrow(art_node* node, uint8_t kind) {
+    art_node* grown = art_node_alloc(kind);
+    grown->count = node->count;
+    grown->prefix_len = node->prefix_len;
+    grown->prefix = node->prefix;
+    grown->leaf = node->leaf;
+    return grown;
+}
+/*
+    adds child under byte to the node at ref, moving it to the next bigger layout when it is full
+    NOTE: you usually won't have to call this yourself, byte mustn't have a child yet
+*/
+void art_add_child(art_node** ref, unsigned char byte, art_node* child) {
+    art_node* node = *ref;
+    switch (node->kind) {
+    case ART_NODE4:
+    case ART_NODE16: {
+        size_t cap = node->kind == ART_NODE4 ? 4 : 16;
+        unsigned char* keys = node->kind == ART_NODE4 ? ((art_node4*)node)->keys : ((art_node16*)node)->keys;
+        art_node** children = node->kind == ART_NODE4 ? ((art_node4*)node)->children : ((art_node16*)node)->children;
+        if (node->count < cap) {
+            size_t at = 0;
+            while (at < node->count && keys[at] < byte) {
+                at += 1;
+            }
+            memmove(keys + at + 1, keys + at, node->count - at);
+            memmove(children + at + 1, children + at, (node->count - at) * sizeof(art_node*));
+            keys[at] = byte;
+            children[at] = child;
+            node->count += 1;
+            return;
+        }
+        if (node->kind == ART_NODE4) {
+            art_node16* grown = (art_node16*)art_node_regrow(node, ART_NODE16);
+            memcpy(grown->keys, keys, 4);
+            memcpy(grown->children, children, 4 * sizeof(art_node*));
+            *ref = &grown->base;
+        } else {
+            art_node48* grown = (art_node48*)art_node_regrow(node, ART_NODE48);
+            for (size_t i = 0; i < 16; i++) {
+                grown->index[keys[i]] = (unsigned char)(i + 1);
+                grown->children[i] = children[i];
+            }
+            *ref = &grown->base;
+        }
+        free(node);
+        art_add_child(ref, byte, child);
+        return;
+    }
+    case ART_NODE48: {
+        art_node48* n = (art_node48*)node;
+        if (node->count < 48) {
+            size_t slot = 0;
+            while (n->children[slot]) {
+                slot += 1;
+            }
+            n->children[slot] = child;
+            n->index[byte] = (unsigned char)(slot + 1);
+            node->count += 1;
+            return;
+        }
+        art_node256* grown = (art_node256*)art_node_regrow(node, ART_NODE256);
+        for (size_t b = 0; b < 256; b++) {
+            if (n->index[b]) {
+                grown->children[b] = n->children[n->index[b] - 1];
+            }
+        }
+        *ref = &grown->base;
+        free(node);
+        art_add_child(ref, byte, child);
+        return;
+    }
+    default: {
+        ((art_node256*)node)->children[byte] = child;
+        node->count += 1;
+        return;
+    }
+    }
+}
+/*
+    takes the child for byte out of the node
+    NOTE: you usually won't have to call this yourself, byte must have a child
+*/
+void art_remove_child(art_node* node, unsigned char byte) {
+    switch (node->kind) {
+    case ART_NODE4:
+    case ART_NODE16: {
+        unsigned char* keys = node->kind == ART_NODE4 ? ((art_node4*)node)->keys : ((art_node16*)node)->keys;
+        art_node** children = node->kind == ART_NODE4 ? ((art_node4*)node)->children : ((art_node16*)node)->children;
+        size_t at = 0;
+        while (keys[at] != byte) {
+            at += 1;
+        }
+        memmove(keys + at, keys + at + 1, node->count - at - 1);
+        memmove(children + at, children + at + 1, (node->count - at - 1) * sizeof(art_node*));
+        break;
+    }
+    case ART_NODE48: {
+        art_node48* n = (art_node48*)node;
+        n->children[n->index[byte] - 1] = NULL;
+        n->index[byte] = 0;
+        break;
+    }
+    default:
+        ((art_node256*)node)->children[byte] = NULL;
+        break;
+    }
+    node->count -= 1;
+}
+/*
+    returns the child at position i in key order and its byte, i must be below .count for node4/16
+    for node48/256 i is a byte to try and NULL comes back if it has no child
+    NOTE: you usually won't have to call this yourself
+*/
+art_node* art_child_at(art_node* node, size_t i, unsigned char* byte) {
+    switch (node->kind) {
+    case ART_NODE4:
+        *byte = ((art_node4*)node)->keys[i];
+        return ((art_node4*)node)->children[i];
+    case ART_NODE16:
+        *byte = ((art_node16*)node)->keys[i];
+        return ((art_node16*)node)->children[i];
+    case ART_NODE48: {
+        art_node48* n = (art_node48*)node;
+        *byte = (unsigned char)i;
+        return n->index[i] ? n->children[n->index[i] - 1] : NULL;
+    }
+    default:
+        *byte = (unsigned char)i;
+        return ((art_node256*)node)->children[i];
+    }
+}
+/* number of positions art_child_at takes for the node */
+size_t art_child_slots(art_node* node) {
+    return node->kind <= ART_NODE16 ? node->count : 256;
+}
+/*
+    frees the node, its compressed path, its leaf and everything below it
+    NOTE: you usually won't have to call this yourself
+*/
+void art_node_free(art_node* node) {
+    if (!node) {
+        return;
+    }
+    for (size_t i = 0; i < art_child_slots(node); i++) {
+        unsigned char byte;
+        art_node_free(art_child_at(node, i, &byte));
+    }
+    free(node->prefix);
+    free(node->leaf);
+    free(node);
+}
+/*
+    returns the number of bytes the node's compressed path shares with key from depth
+    NOTE: you usually won't have to call this yourself
+*/
+size_t art_prefix_match(art_node* node, str key, size_t depth) {
+    size_t limit = key.len - depth < node->prefix_len ? key.len - depth : node->prefix_len;
+    size_t i = 0;
+    while (i < limit && node->prefix[i] == (unsigned char)key.ptr[depth + i]) {
+        i += 1;
+    }
+    return i;
+}
+/*
+    a new node holding only a leaf slot, the rest of the key is its compressed path
+    NOTE: you usually won't have to call this yourself
+*/
+art_node* art_node_for_rest(str key, size_t depth) {
+    art_node* node = art_node_alloc(ART_NODE4);
+    art_set_prefix(node, (const unsigned char*)key.ptr + depth, key.len - depth);
+    return node;
+}
+/*
+    finds the leaf slot for key, adding nodes and splitting compressed paths as needed
+    the slot is NULL if the key wasn't in the tree yet
+    NOTE: you usually won't have to call this yourself
+*/
+void** art_insert_slot(art_node** root, str key) {
+    art_node** ref = root;
+    size_t depth = 0;
+    for (;;) {
+        art_node* node = *ref;
+        if (!node) {
+            *ref = art_node_for_rest(key, depth);
+            return &(*ref)->leaf;
+        }
+        size_t shared = art_prefix_match(node, key, depth);
+        if (shared < node->prefix_len) {
+            // the key leaves the compressed path part way, so branch where they differ
+            art_node* split = art_node_alloc(ART_NODE4);
+            art_set_prefix(split, node->prefix, shared);
+            unsigned char old_byte = node->prefix[shared];
+            art_set_prefix(node, node->prefix + shared + 1, node->prefix_len - shared - 1);
+            art_add_child(&split, old_byte, node);
+            *ref = split;
+            depth += shared;
+            if (depth == key.len) {
+                return &split->leaf;
+            }
+            art_node* rest = art_node_for_rest(key, depth + 1);
+            art_add_child(ref, (unsigned char)key.ptr[depth], rest);
+            return &rest->leaf;
+        }
+        depth += node->prefix_len;
+        if (depth == key.len) {
+            return &node->leaf;
+        }
+        art_node** child = art_find_child(node, (unsigned char)key.ptr[depth]);
+        if (!child) {
+            art_node* rest = art_node_for_rest(key, depth + 1);
+            art_add_child(ref, (unsigned char)key.ptr[depth], rest);
+            return &rest->leaf;
+        }
+        ref = child;
+        depth += 1;
+    }
+}
+/*
+    returns the leaf for key or NULL if key isn't in the tree
+    NOTE: you usually won't have to call this yourself
+*/
+void* art_lookup(art_node* node, str key) {
+    size_t depth = 0;
+    while (node) {
+        if (node->prefix_len) {
+            if (art_prefix_match(node, key, depth) != node->prefix_len) {
+                return NULL;
+            }
+            depth += node->prefix_len;
+        }
+        if (depth == key.len) {
+            return node->leaf;
+        }
+        art_node** child = art_find_child(node, (unsigned char)key.ptr[depth]);
+        node = child ? *child : NULL;
+        depth += 1;
+    }
+    return NULL;
+}
+/*
+    takes the leaf for key out of the tree and returns it, NULL if key isn't there
+    nodes left empty are freed and a node left with one child and no leaf is merged into that child
+    nodes keep their layout, they don't shrink back to a smaller one
+    NOTE: you usually won't have to call this yourself
+*/
+void* art_remove_at(art_node** ref, str key, size_t depth) {
+    art_node* node = *ref;
+    if (!node || art_prefix_match(node, key, depth) != node->prefix_len) {
+        return NULL;
+    }
+    depth += node->prefix_len;
+    void* leaf = NULL;
+    if (depth == key.len) {
+        leaf = node->leaf;
+        node->leaf = NULL;
+    } else {
+        unsigned char byte = (unsigned char)key.ptr[depth];
+        art_node** child = art_find_child(node, byte);
+        if (!child) {
+            return NULL;
+        }
+        leaf = art_remove_at(child, key, depth + 1);
+        if (*child == NULL) {
+            art_remove_child(node, byte);
+        }
+    }
+    if (!leaf || node->leaf) {
+        return leaf;
+    }
+    if (node->count == 0) {
+        free(node->prefix);
+        free(node);
+        *ref = NULL;
+    } else if (node->count == 1) {
+        // put the node's path and branch byte in front of its only child's path
+        art_node* only = NULL;
+        unsigned char byte = 0;
+        for (size_t i = 0; !only; i++) {
+            only = art_child_at(node, i, &byte);
+        }
+        size_t len = node->prefix_len + 1 + only->prefix_len;
+        unsigned char* prefix = (unsigned char*)malloc(len);
+        if (node->prefix_len) {
+            memcpy(prefix, node->prefix, node->prefix_len);
+        }
+        prefix[node->prefix_len] = byte;
+        if (only->prefix_len) {
+            memcpy(prefix + node->prefix_len + 1, only->prefix, only->prefix_len);
+        }
+        free(only->prefix);
+        only->prefix = prefix;
+        only->prefix_len = (uint32_t)len;
+        free(node->prefix);
+        free(node);
+        *ref = only;
+    }
+    return leaf;
+}
+/*
+    calls visit on every leaf below node in key order, path holds the key so far and is restored after
+    stops and returns false as soon as visit returns false
+    NOTE: you usually won't have to call this yourself
+*/
+bool art_walk(art_node* node, string* path, bool (*visit)(str key, void* leaf, void* ctx), void* ctx) {
+    size_t len = string_len(path);
+    if (node->prefix_len) {
+        string_push_bytes(path, (const char*)node->prefix, node->prefix_len);
+    }
+    bool more = !node->leaf || visit(string_as_str(path), node->leaf, ctx);
+    for (size_t i = 0; more && i < art_child_slots(node); i++) {
+        unsigned char byte;
+        art_node* child = art_child_at(node, i, &byte);
+        if (child) {
+            string_push_char(path, (char)byte);
+            more = art_walk(child, path, visit, ctx);
+            string_set_len(path, string_len(path) - 1);
+        }
+    }
+    string_set_len(path, len);
+    return more;
+}
+/*
+    calls visit on every key starting with prefix in key order, until visit returns false
+    only the subtree under prefix is visited
+    NOTE: you usually won't have to call this yourself
+*/
+void art_walk_prefix(art_node* node, str prefix, bool (*visit)(str key, void* leaf, void* ctx), void* ctx) {
+    string path = string_init();
+    size_t depth = 0;
+    while (node) {
+        size_t shared = art_prefix_match(node, prefix, depth);
+        if (depth + shared == prefix.len) {
+            // the prefix ends inside or right after this node's path, everything below matches
+            art_walk(node, &path, visit, ctx);
+            break;
+        }
+        if (shared != node->prefix_len) {
+            break;
+        }
+        if (node->prefix_len) {
+            string_push_bytes(&path, (const char*)node->prefix, node->prefix_len);
+        }
+        depth += node->prefix_len;
+        unsigned char byte = (unsigned char)prefix.ptr[depth];
+        art_node** child = art_find_child(node, byte);
+        string_push_char(&path, (char)byte);
+        node = child ? *child : NULL;
+        depth += 1;
+    }
+    string_deinit(&path);
+}
+/*
+    finds the longest key in the tree that is a prefix of key
+    returns its leaf and sets *len to its length, NULL if no key is a prefix
+    NOTE: you usually won't have to call this yourself
+*/
+void* art_longest_prefix(art_node* node, str key, size_t* len) {
+    void* best = NULL;
+    size_t depth = 0;
+    while (node) {
+        if (art_prefix_match(node, key, depth) != node->prefix_len) {
+            break;
+        }
+        depth += node->prefix_len;
+        if (node->leaf) {
+            best = node->leaf;
+            *len = depth;
+        }
+        if (depth == key.len) {
+            break;
+        }
+        art_node** child = art_find_child(node, (unsigned char)key.ptr[depth]);
+        node = child ? *child : NULL;
+        depth += 1;
+    }
+    return best;
+}
+
+// ordered map from byte string keys to V, lookups cost O(key length) no matter how many keys there are
+// the values are boxed, each key's value lives in its own allocation so pointers to it stay valid until it's removed
+// NOTE: needs gen_dyn_with_deps(V, typename) to be generated first
+#define gen_art(V, typename)\
+typedef struct {\
+    art_node* root;\
+    size_t len;\
+} art_##typename;\
+/* result of art_longest_prefix, .len is the length of the matching key */\
+typedef struct {\
+    bool ok;\
+    size_t len;\
+    V value;\
+} art_match_##typename;\
+/*
+    initialise an empty tree, nothing is allocated until the first insert
+
+    NOTE: call art_deinit to free
+*/\
+art_##typename art_init_##typename() {\
+    return (art_##typename){.root = NULL, .len = 0};\
+}\
+/*
+    copies key into the tree with value
+    returns false if key is already in the tree, like map_insert
+*/\
+bool art_insert_##typename(art_##typename *self, str key, V value) {\
+    void** slot = art_insert_slot(&self->root, key);\
+    if (*slot) {\
+        return false;\
+    }\
+    V* boxed = (V*)malloc(sizeof(V));\
+    *boxed = value;\
+    *slot = boxed;\
+    self->len += 1;\
+    return true;\
+}\
+/* returns false if key isn't in the tree */\
+bool art_update_##typename(art_##typename *self, str key, V value) {\
+    V* boxed = (V*)art_lookup(self->root, key);\
+    if (!boxed) {\
+        return false;\
+    }\
+    *boxed = value;\
+    return true;\
+}\
+/*
+    get value by key
+    returns the value as an option
+*/\
+option_##typename art_get_##typename(art_##typename *self, str key) {\
+    V* boxed = (V*)art_lookup(self->root, key);\
+    if (!boxed) {\
+        return (option_##typename){.ok = false};\
+    }\
+    return (option_##typename){.ok = true, .value = *boxed};\
+}\
+/* returns a pointer to the value for key, valid until key is removed, NULL if it isn't in the tree */\
+V* art_get_ptr_##typename(art_##typename *self, str key) {\
+    return (V*)art_lookup(self->root, key);\
+}\
+/* returns false if key isn't in the tree */\
+bool art_remove_##typename(art_##typename *self, str key) {\
+    void* boxed = art_remove_at(&self->root, key, 0);\
+    if (!boxed) {\
+        return false;\
+    }\
+    free(boxed);\
+    self->len -= 1;\
+    return true;\
+}\
+/*
+    finds the longest key in the tree that key starts with, i.e. the most specific route for a path
+    returns .ok = false if no key is a prefix of key
+*/\
+art_match_##typename art_longest_prefix_##typename(art_##typename *self, str key) {\
+    size_t len = 0;\
+    V* boxed = (V*)art_longest_prefix(self->root, key, &len);\
+    if (!boxed) {\
+        return (art_match_##typename){.ok = false};\
+    }\
+    return (art_match_##typename){.ok = true, .len = len, .value = *boxed};\
+}\
+typedef struct {\
+    bool (*visit)(str key, V* value, void* ctx);\
+    void* ctx;\
+} art_visitor_##typename;\
+bool art_visit_##typename(str key, void* leaf, void* ctx) {\
+    art_visitor_##typename* visitor = (art_visitor_##typename*)ctx;\
+    return visitor->visit(key, (V*)leaf, visitor->ctx);\
+}\
+/*
+    calls visit with every key starting with prefix and its value in key order, an empty prefix visits everything
+    visit returns false to stop early, ctx is passed through untouched
+    NOTE: the key view is only valid during the call
+*/\
+void art_prefix_each_##typename(art_##typename *self, str prefix, bool (*visit)(str key, V* value, void* ctx), void* ctx) {\
+    art_visitor_##typename visitor = {.visit = visit, .ctx = ctx};\
+    art_walk_prefix(self->root, prefix, art_visit_##typename, &visitor);\
+}\
+void art_deinit_##typename(art_##typename *self) {\
+    art_node_free(self->root);\
+    self->root = NULL;\
+    self->len = 0;\
+}\
+
+#define gen_art_with_deps(V, typename)\
+gen_dyn_with_deps(V, typename)\
+gen_art(V, typename)
+
+
+
+/* ################# SUFFIX ARRAY ################# */
+
+
+
+/*
+    sa-is ("two efficient algorithms for linear time suffix array construction" by nong, zhang and chan),
+    following the structure of the atcoder library
+    generates suffix_array_sais_##typename over n symbols of type S in 0..upper with positions of type P,
+    it sorts the lms substrings by induction, names them and recurses on the names with suffix_array_sais_##rec_typename
+    the text is read as it is, so the top level runs straight over the bytes and 32 bit positions halve the memory
+    NOTE: you usually won't have to call this yourself, use suffix_array
+*/
+#define gen_suffix_array_sais(S, P, typename, rec_typename)\
+/*
+    places the m lms suffixes of order at the ends of their buckets, then induces the l and s type suffixes from them
+    (P)-1 marks an empty slot while the suffix array is filled in
+*/\
+void suffix_array_induce_##typename(const S* s, P n, P upper, const bool* ls, const P* sum_l, const P* sum_s, const P* order, P m, P* sa) {\
+    P* buckets = (P*)malloc(((size_t)upper + 1) * sizeof(P));\
+    for (P i = 0; i < n; i++) {\
+        sa[i] = (P)-1;\
+    }\
+    memcpy(buckets, sum_s, ((size_t)upper + 1) * sizeof(P));\
+    for (P i = 0; i < m; i++) {\
+        sa[buckets[s[order[i]]]++] = order[i];\
+    }\
+    memcpy(buckets, sum_l, ((size_t)upper + 1) * sizeof(P));\
+    sa[buckets[s[n - 1]]++] = n - 1;\
+    for (P i = 0; i < n; i++) {\
+        P v = sa[i];\
+        if (v != (P)-1 && v >= 1 && !ls[v - 1]) {\
+            sa[buckets[s[v - 1]]++] = v - 1;\
+        }\
+    }\
+    memcpy(buckets, sum_l, ((size_t)upper + 1) * sizeof(P));\
+    for (P i = n; i-- > 0;) {\
+        P v = sa[i];\
+        if (v != (P)-1 && v >= 1 && ls[v - 1]) {\
+            sa[--buckets[s[v - 1] + 1]] = v - 1;\
+        }\
+    }\
+    free(buckets);\
+}\
+void suffix_array_sais_##typename(const S* s, P n, P upper, P* sa) {\
+    if (n == 0) {\
+        return;\
+    }\
+    if (n == 1) {\
+        sa[0] = 0;\
+        return;\
+    }\
+    if (n == 2) {\
+        sa[0] = s[0] < s[1] ? 0 : 1;\
+        sa[1] = s[0] < s[1] ? 1 : 0;\
+        return;\
+    }\
+    /* ls[i] is true if suffix i is smaller than suffix i + 1 (s type) */\
+    bool* ls = (bool*)calloc(n, sizeof(bool));\
+    for (P i = n - 1; i-- > 0;) {\
+        ls[i] = s[i] == s[i + 1] ? ls[i + 1] : s[i] < s[i + 1];\
+    }\
+    /* bucket starts, sum_l for l type suffixes and sum_s for s type ones */\
+    P* sum_l = (P*)calloc(2 * ((size_t)upper + 2), sizeof(P));\
+    P* sum_s = sum_l + upper + 2;\
+    for (P i = 0; i < n; i++) {\
+        if (!ls[i]) {\
+            sum_s[s[i]] += 1;\
+        } else {\
+            sum_l[s[i] + 1] += 1;\
+        }\
+    }\
+    for (P i = 0; i <= upper; i++) {\
+        sum_s[i] += sum_l[i];\
+        if (i < upper) {\
+            sum_l[i + 1] += sum_s[i];\
+        }\
+    }\
+\
+    /* no two lms positions are neighbours, so there are at most n / 2 */\
+    P* lms_map = (P*)malloc(((size_t)n + 1) * sizeof(P));\
+    P* lms = (P*)malloc(((size_t)n / 2 + 1) * sizeof(P));\
+    P m = 0;\
+    lms_map[0] = (P)-1;\
+    lms_map[n] = (P)-1;\
+    for (P i = 1; i < n; i++) {\
+        if (!ls[i - 1] && ls[i]) {\
+            lms[m] = i;\
+            lms_map[i] = m++;\
+        } else {\
+            lms_map[i] = (P)-1;\
+        }\
+    }\
+\
+    /* without lms positions there is nothing to place, only the induction from the last suffix */\
+    suffix_array_induce_##typename(s, n, upper, ls, sum_l, sum_s, m ? lms : NULL, m, sa);\
+    if (m) {\
+        /* the lms substrings now come out sorted, move them to the front of sa and name them so equal ones share a name */\
+        for (P i = 0, k = 0; i < n; i++) {\
+            if (lms_map[sa[i]] != (P)-1) {\
+                sa[k++] = sa[i];\
+            }\
+        }\
+        P* names = (P*)malloc((size_t)m * sizeof(P));\
+        P rec_upper = 0;\
+        names[lms_map[sa[0]]] = 0;\
+        for (P i = 1; i < m; i++) {\
+            P l = sa[i - 1];\
+            P r = sa[i];\
+            P end_l = lms_map[l] + 1 < m ? lms[lms_map[l] + 1] : n;\
+            P end_r = lms_map[r] + 1 < m ? lms[lms_map[r] + 1] : n;\
+            bool same = true;\
+            if (end_l - l != end_r - r) {\
+                same = false;\
+            } else {\
+                while (l < end_l && s[l] == s[r]) {\
+                    l += 1;\
+                    r += 1;\
+                }\
+                if (l == n || s[l] != s[r]) {\
+                    same = false;\
+                }\
+            }\
+            if (!same) {\
+                rec_upper += 1;\
+            }\
+            names[lms_map[sa[i]]] = rec_upper;\
+        }\
+        /* only the names are needed from here, free the map before recursing */\
+        free(lms_map);\
+        lms_map = NULL;\
+        P* sorted = (P*)malloc((size_t)m * sizeof(P));\
+        suffix_array_sais_##rec_typename(names, m, rec_upper, sorted);\
+        free(names);\
+        for (P i = 0; i < m; i++) {\
+            sorted[i] = lms[sorted[i]];\
+        }\
+        suffix_array_induce_##typename(s, n, upper, ls, sum_l, sum_s, sorted, m, sa);\
+        free(sorted);\
+    }\
+    free(lms_map);\
+    free(lms);\
+    free(sum_l);\
+    free(ls);\
+}
+
+// names recurse into themselves, texts into the names of the same position width
+gen_suffix_array_sais(uint32_t, uint32_t, u32, u32);
+gen_suffix_array_sais(unsigned char, uint32_t, u8_u32, u32);
+gen_suffix_array_sais(size_t, size_t, size_t, size_t);
+gen_suffix_array_sais(unsigned char, size_t, u8_size_t, size_t);
+
+/*
+    sorted start positions of every suffix of text, built in O(n) with sa-is
+    besides the result it needs about 10 bytes of scratch memory per byte of text at worst, texts under 4 GB use 32 bit positions
+
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t suffix_array(str text) {
+    dyn_size_t sa = dyn_init_with_cap_size_t(text.len + 1);
+    const unsigned char* bytes = (const unsigned char*)text.ptr;
+    if (text.len < UINT32_MAX) {
+        // sort into the front half of the result, then widen from the back
+        // where position i only overwrites the 32 bit slots 2i and 2i + 1 that were already read
+        uint32_t* narrow = (uint32_t*)sa.buf;
+        suffix_array_sais_u8_u32(bytes, (uint32_t)text.len, 255, narrow);
+        for (size_t i = text.len; i-- > 0;) {
+            uint32_t position;
+            memcpy(&position, (const char*)sa.buf + i * sizeof(uint32_t), sizeof(uint32_t));
+            sa.buf[i] = position;
+        }
+    } else {
+        suffix_array_sais_u8_size_t(bytes, text.len, 255, sa.buf);
+    }
+    sa.len = text.len;
+    return sa;
+}
+/*
+    longest common prefix of each pair of neighbouring suffixes, lcp.buf[i] is for sa.buf[i] and sa.buf[i + 1]
+    built in O(n) with kasai's algorithm
+
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t suffix_array_lcp(str text, const dyn_size_t* sa) {
+    size_t n = text.len;
+    dyn_size_t lcp = dyn_init_with_cap_size_t(n + 1);
+    if (n == 0) {
+        return lcp;
+    }
+    size_t* rank = (size_t*)malloc(n * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        rank[sa->buf[i]] = i;
+    }
+    lcp.len = n - 1;
+    // the lcp of suffix i + 1 with its neighbour is at least the one of suffix i minus 1
+    size_t h = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (h > 0) {
+            h -= 1;
+        }
+        if (rank[i] == 0) {
+            continue;
+        }
+        size_t j = sa->buf[rank[i] - 1];
+        while (i + h < n && j + h < n && text.ptr[i + h] == text.ptr[j + h]) {
+            h += 1;
+        }
+        lcp.buf[rank[i] - 1] = h;
+    }
+    free(rank);
+    return lcp;
+}
+
+// suffix array over a text for answering many substring queries without rescanning it
+// NOTE: .text is a view, the text must stay alive and unchanged while the index is used
+typedef struct {
+    str text;
+    dyn_size_t sa;
+} text_index;
+
+/*
+    builds the suffix array of text in O(n)
+
+    NOTE: call text_index_deinit to free
+*/
+text_index text_index_init(str text) {
+    return (text_index){.text = text, .sa = suffix_array(text)};
+}
+/*
+    compares pattern with the start of suffix at, a suffix shorter than pattern that matches it so far comes first
+    NOTE: you usually won't have to call this yourself
+*/
+int text_index_compare(const text_index* self, size_t at, str pattern) {
+    size_t rest = self->text.len - at;
+    size_t len = rest < pattern.len ? rest : pattern.len;
+    int order = len ? memcmp(self->text.ptr + at, pattern.ptr, len) : 0;
+    if (order != 0 || len == pattern.len) {
+        return order;
+    }
+    return -1;
+}
+/*
+    returns {first, end}, the range of the suffix array whose suffixes start with pattern
+    found with two binary searches, O(m log n) for a pattern of m bytes
+*/
+tuple_size_t_size_t text_index_range(const text_index* self, str pattern) {
+    size_t low = 0;
+    size_t high = self->sa.len;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (text_index_compare(self, self->sa.buf[mid], pattern) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    size_t first = low;
+    high = self->sa.len;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (text_index_compare(self, self->sa.buf[mid], pattern) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return (tuple_size_t_size_t){first, low};
+}
+/* returns the number of (possibly overlapping) matches of pattern, an empty pattern matches at every position */
+size_t text_index_count(const text_index* self, str pattern) {
+    tuple_size_t_size_t range = text_index_range(self, pattern);
+    return range.two - range.one;
+}
+bool text_index_contains(const text_index* self, str pattern) {
+    return text_index_count(self, pattern) > 0;
+}
+int text_index_compare_position(const void* one, const void* two) {
+    size_t a = *(const size_t*)one;
+    size_t b = *(const size_t*)two;
+    return (a > b) - (a < b);
+}
+/*
+    returns the start of every match of pattern in ascending order, overlapping ones included
+
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t text_index_locate(const text_index* self, str pattern) {
+    tuple_size_t_size_t range = text_index_range(self, pattern);
+    size_t count = range.two - range.one;
+    dyn_size_t found = dyn_init_with_cap_size_t(count + 1);
+    memcpy(found.buf, self->sa.buf + range.one, count * sizeof(size_t));
+    found.len = count;
+    qsort(found.buf, count, sizeof(size_t), text_index_compare_position);
+    return found;
+}
+void text_index_deinit(text_index* self) {
+    dyn_deinit_size_t(&self->sa);
+}
+
+
+
+/* ################# GRAPH ################# */
+
+
+
+// edge from .one to .two
+struct_tuple(size_t, size_t, edge);
+gen_dyn_with_deps(tuple_edge, edge);
+// edge .one with weight .two
+struct_tuple(tuple_edge, double, weighted_edge);
+gen_dyn_with_deps(tuple_weighted_edge, weighted_edge);
+
+#define GRAPH_UNREACHABLE ((size_t)-1)
+
+// directed graph in compressed sparse row form
+// the neighbours of v are .targets.buf[.offsets.buf[v]] up to .targets.buf[.offsets.buf[v + 1]]
+// .weights is empty for unweighted graphs, otherwise .weights.buf[i] is the weight of .targets.buf[i]
+typedef struct {
+    size_t vertex_count;
+    dyn_size_t offsets;
+    dyn_size_t targets;
+    dyn_double weights;
+} graph;
+struct_result(graph, graph);
+
+/*
+    counting sort of the edges by source into the offsets/targets arrays
+    NOTE: you usually won't have to call this yourself, use graph_from_edges or graph_from_weighted_edges
+*/
+result_graph graph_from_edge_list(size_t vertex_count, size_t edge_count, const tuple_edge* edges, size_t edge_stride, const double* weights, size_t weight_stride) {
+    for (size_t i = 0; i < edge_count; i++) {
+        const tuple_edge* e = (const tuple_edge*)((const char*)edges + i * edge_stride);
+        if (e->one >= vertex_count || e->two >= vertex_count) {
+            return (result_graph){.err = ERR_INDEX_OUT_OF_BOUNDS};
+        }
+    }
+
+    graph self = {
+        .vertex_count = vertex_count,
+        .offsets = dyn_init_with_cap_size_t(vertex_count + 1),
+        .targets = dyn_init_with_cap_size_t(edge_count),
+        .weights = dyn_init_with_cap_double(weights ? edge_count : 0),
+    };
+    size_t* offsets = self.offsets.buf;
+    self.offsets.len = vertex_count + 1;
+    self.targets.len = edge_count;
+    if (weights) {
+        self.weights.len = edge_count;
+    }
+
+    // calloc already zeroed the counts, offsets[v + 1] counts the out degree of v
+    for (size_t i = 0; i < edge_count; i++) {
+        const tuple_edge* e = (const tuple_edge*)((const char*)edges + i * edge_stride);
+        offsets[e->one + 1] += 1;
+    }
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    size_t* cursor = (size_t*)malloc(sizeof(size_t) * (vertex_count + 1));
+    memcpy(cursor, offsets, sizeof(size_t) * (vertex_count + 1));
+    for (size_t i = 0; i < edge_count; i++) {
+        const tuple_edge* e = (const tuple_edge*)((const char*)edges + i * edge_stride);
+        size_t slot = cursor[e->one]++;
+        self.targets.buf[slot] = e->two;
+        if (weights) {
+            self.weights.buf[slot] = *(const double*)((const char*)weights + i * weight_stride);
+        }
+    }
+    free(cursor);
+
+    return (result_graph){.err = ERR_NONE, .value = self};
+}
+/*
+    builds an unweighted graph with vertices 0..vertex_count - 1
+    returns ERR_INDEX_OUT_OF_BOUNDS if an edge points outside of that range
+
+    NOTE: call graph_deinit to free
+*/
+result_graph graph_from_edges(size_t vertex_count, dyn_edge* edges) {
+    return graph_from_edge_list(vertex_count, edges->len, edges->buf, sizeof(tuple_edge), NULL, 0);
+}
+/*
+    same as graph_from_edges but every edge carries a weight, used by graph_dijkstra
+*/
+result_graph graph_from_weighted_edges(size_t vertex_count, dyn_weighted_edge* edges) {
+    if (edges->len == 0) {
+        return graph_from_edge_list(vertex_count, 0, NULL, 0, NULL, 0);
+    }
+    return graph_from_edge_list(
+        vertex_count, edges->len,
+        &edges->buf[0].one, sizeof(tuple_weighted_edge),
+        &edges->buf[0].two, sizeof(tuple_weighted_edge)
+    );
+}
+/* returns the number of edges leaving vertex */
+size_t graph_degree(graph* self, size_t vertex) {
+    return self->offsets.buf[vertex + 1] - self->offsets.buf[vertex];
+}
+void graph_deinit(graph* self) {
+    dyn_deinit_size_t(&self->offsets);
+    dyn_deinit_size_t(&self->targets);
+    dyn_deinit_double(&self->weights);
+    self->vertex_count = 0;
+}
+
+// bitvector helpers, one bit per vertex
+#define graph_bit_words(count) (((count) + 63) / 64)
+#define graph_bit_test(bits, i) (((bits)[(i) / 64] >> ((i) % 64)) & 1)
+#define graph_bit_set(bits, i) ((bits)[(i) / 64] |= (uint64_t)1 << ((i) % 64))
+
+/*
+    breadth first search from source using a frontier bitvector per level
+    frontiers are walked in vertex order so the offsets/targets arrays are read front to back
+
+    returns the hop count from source for every vertex, GRAPH_UNREACHABLE if it can't be reached
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t graph_bfs(graph* self, size_t source) {
+    size_t n = self->vertex_count;
+    dyn_size_t dist = dyn_init_with_cap_size_t(n);
+    dist.len = n;
+    for (size_t v = 0; v < n; v++) {
+        dist.buf[v] = GRAPH_UNREACHABLE;
+    }
+    if (source >= n) {
+        return dist;
+    }
+
+    size_t words = graph_bit_words(n);
+    uint64_t* visited = (uint64_t*)calloc(words, sizeof(uint64_t));
+    uint64_t* frontier = (uint64_t*)calloc(words, sizeof(uint64_t));
+    uint64_t* next = (uint64_t*)calloc(words, sizeof(uint64_t));
+
+    graph_bit_set(visited, source);
+    graph_bit_set(frontier, source);
+    dist.buf[source] = 0;
+
+    for (size_t level = 1; ; level++) {
+        bool more = false;
+        for (size_t w = 0; w < words; w++) {
+            uint64_t bits = frontier[w];
+            while (bits) {
+                size_t v = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                for (size_t e = self->offsets.buf[v]; e < self->offsets.buf[v + 1]; e++) {
+                    size_t u = self->targets.buf[e];
+                    if (!graph_bit_test(visited, u)) {
+                        graph_bit_set(visited, u);
+                        graph_bit_set(next, u);
+                        dist.buf[u] = level;
+                        more = true;
+                    }
+                }
+            }
+        }
+        if (!more) {
+            break;
+        }
+        uint64_t* tmp = frontier;
+        frontier = next;
+        next = tmp;
+        memset(next, 0, words * sizeof(uint64_t));
+    }
+
+    free(visited);
+    free(frontier);
+    free(next);
+    return dist;
+}
+/*
+    iterative depth first search from source with a visited bitvector
+
+    returns the vertices reachable from source in preorder
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t graph_dfs(graph* self, size_t source) {
+    size_t n = self->vertex_count;
+    dyn_size_t order = dyn_init_with_cap_size_t(n);
+    if (source >= n) {
+        return order;
+    }
+
+    uint64_t* visited = (uint64_t*)calloc(graph_bit_words(n), sizeof(uint64_t));
+    // next edge to look at for every vertex on the stack
+    size_t* cursor = (size_t*)malloc(sizeof(size_t) * n);
+    dyn_size_t stack = dyn_init_size_t();
+
+    graph_bit_set(visited, source);
+    cursor[source] = self->offsets.buf[source];
+    dyn_push_size_t(&order, source);
+    dyn_push_size_t(&stack, source);
+
+    while (stack.len) {
+        size_t v = stack.buf[stack.len - 1];
+        size_t end = self->offsets.buf[v + 1];
+        while (cursor[v] < end && graph_bit_test(visited, self->targets.buf[cursor[v]])) {
+            cursor[v] += 1;
+        }
+        if (cursor[v] == end) {
+            stack.len -= 1;
+            continue;
+        }
+        size_t u = self->targets.buf[cursor[v]++];
+        graph_bit_set(visited, u);
+        cursor[u] = self->offsets.buf[u];
+        dyn_push_size_t(&order, u);
+        dyn_push_size_t(&stack, u);
+    }
+
+    dyn_deinit_size_t(&stack);
+    free(cursor);
+    free(visited);
+    return order;
+}
+
+// 4-ary min heap of vertices keyed by distance, .pos tracks where each vertex sits for decrease key
+typedef struct {
+    size_t* heap;
+    size_t* pos;
+    double* key;
+    size_t len;
+} graph_heap;
+#define GRAPH_HEAP_ARITY 4
+#define GRAPH_HEAP_ABSENT ((size_t)-1)
+
+void graph_heap_sift_up(graph_heap* self, size_t i) {
+    size_t v = self->heap[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / GRAPH_HEAP_ARITY;
+        if (self->key[self->heap[parent]] <= self->key[v]) {
+            break;
+        }
+        self->heap[i] = self->heap[parent];
+        self->pos[self->heap[i]] = i;
+        i = parent;
+    }
+    self->heap[i] = v;
+    self->pos[v] = i;
+}
+void graph_heap_sift_down(graph_heap* self, size_t i) {
+    size_t v = self->heap[i];
+    for (;;) {
+        size_t first = i * GRAPH_HEAP_ARITY + 1;
+        if (first >= self->len) {
+            break;
+        }
+        size_t last = first + GRAPH_HEAP_ARITY < self->len ? first + GRAPH_HEAP_ARITY : self->len;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; c++) {
+            if (self->key[self->heap[c]] < self->key[self->heap[best]]) {
+                best = c;
+            }
+        }
+        if (self->key[self->heap[best]] >= self->key[v]) {
+            break;
+        }
+        self->heap[i] = self->heap[best];
+        self->pos[self->heap[i]] = i;
+        i = best;
+    }
+    self->heap[i] = v;
+    self->pos[v] = i;
+}
+/*
+    single source shortest paths using a 4-ary heap with decrease key
+    unweighted graphs use a weight of 1 for every edge, negative weights are not supported
+
+    returns the distance from source for every vertex, INFINITY if it can't be reached
+    NOTE: call dyn_deinit_double to free
+*/
+dyn_double graph_dijkstra(graph* self, size_t source) {
+    size_t n = self->vertex_count;
+    dyn_double dist = dyn_init_with_cap_double(n);
+    dist.len = n;
+    for (size_t v = 0; v < n; v++) {
+        dist.buf[v] = INFINITY;
+    }
+    if (source >= n) {
+        return dist;
+    }
+
+    graph_heap heap = {
+        .heap = (size_t*)malloc(sizeof(size_t) * n),
+        .pos = (size_t*)malloc(sizeof(size_t) * n),
+        .key = dist.buf,
+        .len = 0,
+    };
+    for (size_t v = 0; v < n; v++) {
+        heap.pos[v] = GRAPH_HEAP_ABSENT;
+    }
+    bool weighted = self->weights.len != 0;
+
+    dist.buf[source] = 0;
+    heap.heap[heap.len++] = source;
+    heap.pos[source] = 0;
+
+    while (heap.len) {
+        size_t v = heap.heap[0];
+        heap.len -= 1;
+        if (heap.len) {
+            heap.heap[0] = heap.heap[heap.len];
+            graph_heap_sift_down(&heap, 0);
+        }
+        // settled vertices are never pushed again since their distance can't shrink
+        heap.pos[v] = GRAPH_HEAP_ABSENT;
+
+        for (size_t e = self->offsets.buf[v]; e < self->offsets.buf[v + 1]; e++) {
+            size_t u = self->targets.buf[e];
+            double candidate = dist.buf[v] + (weighted ? self->weights.buf[e] : 1.0);
+            if (candidate >= dist.buf[u]) {
+                continue;
+            }
+            dist.buf[u] = candidate;
+            if (heap.pos[u] == GRAPH_HEAP_ABSENT) {
+                heap.heap[heap.len] = u;
+                graph_heap_sift_up(&heap, heap.len++);
+            } else {
+                graph_heap_sift_up(&heap, heap.pos[u]);
+            }
+        }
+    }
+
+    free(heap.heap);
+    free(heap.pos);
+    return dist;
+}
+
+// reusable barrier, pthread_barrier_t isn't available everywhere
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t count;
+    size_t waiting;
+    size_t generation;
+} graph_barrier;
+
+void graph_barrier_init(graph_barrier* self, size_t count) {
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->cond, NULL);
+    self->count = count;
+    self->waiting = 0;
+    self->generation = 0;
+}
+void graph_barrier_wait(graph_barrier* self) {
+    pthread_mutex_lock(&self->lock);
+    size_t generation = self->generation;
+    self->waiting += 1;
+    if (self->waiting == self->count) {
+        self->waiting = 0;
+        self->generation += 1;
+        pthread_cond_broadcast(&self->cond);
+    } else {
+        while (generation == self->generation) {
+            pthread_cond_wait(&self->cond, &self->lock);
+        }
+    }
+    pthread_mutex_unlock(&self->lock);
+}
+void graph_barrier_deinit(graph_barrier* self) {
+    pthread_mutex_destroy(&self->lock);
+    pthread_cond_destroy(&self->cond);
+}
+
+// state shared between the workers of graph_bfs_parallel
+typedef struct {
+    graph* graph;
+    size_t* dist;
+    _Atomic uint64_t* visited;
+    _Atomic uint64_t* frontier;
+    _Atomic uint64_t* next;
+    size_t words;
+    size_t thread_count;
+    atomic_bool more;
+    bool done;
+    graph_barrier barrier;
+} graph_bfs_shared;
+typedef struct {
+    graph_bfs_shared* shared;
+    size_t id;
+} graph_bfs_worker;
+
+void* graph_bfs_parallel_worker(void* arg) {
+    graph_bfs_worker* worker = (graph_bfs_worker*)arg;
+    graph_bfs_shared* shared = worker->shared;
+    graph* g = shared->graph;
+    // every worker owns the same slice of frontier words on every level
+    size_t begin = shared->words * worker->id / shared->thread_count;
+    size_t end = shared->words * (worker->id + 1) / shared->thread_count;
+    _Atomic uint64_t* frontier = shared->frontier;
+    _Atomic uint64_t* next = shared->next;
+
+    for (size_t level = 1; ; level++) {
+        bool found = false;
+        for (size_t w = begin; w < end; w++) {
+            uint64_t bits = atomic_load_explicit(&frontier[w], memory_order_relaxed);
+            while (bits) {
+                size_t v = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                for (size_t e = g->offsets.buf[v]; e < g->offsets.buf[v + 1]; e++) {
+                    size_t u = g->targets.buf[e];
+                    uint64_t bit = (uint64_t)1 << (u % 64);
+                    if (atomic_load_explicit(&shared->visited[u / 64], memory_order_relaxed) & bit) {
+                        continue;
+                    }
+                    // only the thread that flips the visited bit writes the distance
+                    uint64_t old = atomic_fetch_or_explicit(&shared->visited[u / 64], bit, memory_order_relaxed);
+                    if (!(old & bit)) {
+                        shared->dist[u] = level;
+                        atomic_fetch_or_explicit(&next[u / 64], bit, memory_order_relaxed);
+                        found = true;
+                    }
+                }
+            }
+        }
+        if (found) {
+            atomic_store_explicit(&shared->more, true, memory_order_relaxed);
+        }
+
+        graph_barrier_wait(&shared->barrier);
+        if (worker->id == 0) {
+            shared->done = !atomic_load_explicit(&shared->more, memory_order_relaxed);
+            atomic_store_explicit(&shared->more, false, memory_order_relaxed);
+        }
+        for (size_t w = begin; w < end; w++) {
+            atomic_store_explicit(&frontier[w], 0, memory_order_relaxed);
+        }
+        graph_barrier_wait(&shared->barrier);
+
+        if (shared->done) {
+            break;
+        }
+        _Atomic uint64_t* tmp = frontier;
+        frontier = next;
+        next = tmp;
+    }
+    return NULL;
+}
+/*
+    level synchronous breadth first search split over thread_count threads
+    if thread_count is 0, uses the number of online cpus
+
+    returns the same distances as graph_bfs
+    NOTE: call dyn_deinit_size_t to free
+*/
+dyn_size_t graph_bfs_parallel(graph* self, size_t source, size_t thread_count) {
+    size_t n = self->vertex_count;
+    if (thread_count == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpus > 0 ? (size_t)cpus : 1;
+    }
+    size_t words = graph_bit_words(n);
+    if (thread_count > words) {
+        thread_count = words;
+    }
+    if (thread_count <= 1 || source >= n) {
+        return graph_bfs(self, source);
+    }
+
+    dyn_size_t dist = dyn_init_with_cap_size_t(n);
+    dist.len = n;
+    for (size_t v = 0; v < n; v++) {
+        dist.buf[v] = GRAPH_UNREACHABLE;
+    }
+
+    graph_bfs_shared shared = {
+        .graph = self,
+        .dist = dist.buf,
+        .visited = (_Atomic uint64_t*)calloc(words, sizeof(uint64_t)),
+        .frontier = (_Atomic uint64_t*)calloc(words, sizeof(uint64_t)),
+        .next = (_Atomic uint64_t*)calloc(words, sizeof(uint64_t)),
+        .words = words,
+        .thread_count = thread_count,
+        .done = false,
+    };
+    atomic_init(&shared.more, false);
+    graph_barrier_init(&shared.barrier, thread_count);
+
+    uint64_t bit = (uint64_t)1 << (source % 64);
+    atomic_store(&shared.visited[source / 64], bit);
+    atomic_store(&shared.frontier[source / 64], bit);
+    dist.buf[source] = 0;
+
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * thread_count);
+    graph_bfs_worker* workers = (graph_bfs_worker*)malloc(sizeof(graph_bfs_worker) * thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        workers[i] = (graph_bfs_worker){.shared = &shared, .id = i};
+        if (i > 0) {
+            pthread_create(&threads[i], NULL, graph_bfs_parallel_worker, &workers[i]);
+        }
+    }
+    // the calling thread works as worker 0
+    graph_bfs_parallel_worker(&workers[0]);
+    for (size_t i = 1; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    graph_barrier_deinit(&shared.barrier);
+    free(threads);
+    free(workers);
+    free((void*)shared.visited);
+    free((void*)shared.frontier);
+    free((void*)shared.next);
+    return dist;
+}
+
+
+
+/* ################# RANGE QUERIES ################# */
+
+
+
+// fenwick tree (binary indexed tree) for prefix sums over a numeric type
+// .tree.buf[i - 1] holds the sum of the (i & -i) values ending at index i - 1
+// NOTE: needs gen_dyn_with_deps(T, typename) to be generated first
+#define gen_fenwick(T, typename)\
+typedef struct {\
+    dyn_##typename tree;\
+} fenwick_##typename;\
+/*
+    initialise a fenwick tree of len zeros
+
+    NOTE: call fenwick_deinit to free
+*/\
+fenwick_##typename fenwick_init_##typename(size_t len) {\
+    dyn_##typename tree = dyn_init_with_cap_##typename(len);\
+    tree.len = len;\
+    return (fenwick_##typename){.tree = tree};\
+}\
+/*
+    builds a fenwick tree over a copy of values in O(n) by pushing every partial sum to its parent once
+
+    NOTE: call fenwick_deinit to free
+*/\
+fenwick_##typename fenwick_from_dyn_##typename(dyn_##typename *values) {\
+    fenwick_##typename self = fenwick_init_##typename(values->len);\
+    T* tree = self.tree.buf;\
+    size_t len = values->len;\
+    memcpy(tree, values->buf, sizeof(T) * len);\
+    for (size_t i = 1; i <= len; i++) {\
+        size_t parent = i + (i & -i);\
+        if (parent <= len) {\
+            tree[parent - 1] += tree[i - 1];\
         }\
-        index = (index + 1) % self->entries.cap;\
     }\
-    self->entries.buf[index].active = true;\
-    self->entries.buf[index].key = key;\
-    self->entries.buf[index].value = value;\
-    self->active_count += 1;\
-    return true;\
+    return self;\
+}\
+size_t fenwick_len_##typename(fenwick_##typename *self) {\
+    return self->tree.len;\
 }\
 /*
-    get entry by key
-    returns an option to the entry
- */\
-option_map_entry_##typenames map_get_##typenames(map_##typenames *self, K key) {\
-    size_t index = self->hash(key) % self->entries.cap;\
-    for (size_t i = 0; i < self->entries.cap; i++) {\
-        if (!self->entries.buf[index].active) {\
-            break;\
-        }\
-        if (self->key_compare(self->entries.buf[index].key, key)) {\
-            break;\
-        } \
-        index = (index + 1) % self->entries.cap;\
+    adds delta to the value at index in O(log n)
+    returns ERR_INDEX_OUT_OF_BOUNDS if index is out of bounds
+*/\
+result_##typename fenwick_add_##typename(fenwick_##typename *self, size_t index, T delta) {\
+    if (index >= self->tree.len) {\
+        return (result_##typename){.err = ERR_INDEX_OUT_OF_BOUNDS};\
     }\
-    if (self->entries.buf[index].active && self->key_compare(self->entries.buf[index].key, key)) {\
-        return (option_map_entry_##typenames){\
-            .ok = true,\
-            .value = self->entries.buf[index],\
-        };\
+    for (size_t i = index + 1; i <= self->tree.len; i += i & -i) {\
+        self->tree.buf[i - 1] += delta;\
     }\
-    return (option_map_entry_##typenames){\
-        .ok = false,\
-    };\
+    return (result_##typename){.err = ERR_NONE};\
 }\
-bool map_update_##typenames(map_##typenames *self, K key, V value) {\
-    size_t index = self->hash(key) % self->entries.cap;\
-    bool found = false;\
-    while (self->entries.buf[index].active) {\
-        if (self->key_compare(self->entries.buf[index].key, key)) {\
-            found = true;\
-            break;\
-        }\
-        index = (index + 1) % self->entries.cap;\
+/*
+    returns the sum of the values in [0, end) in O(log n)
+    end is clamped to the length of the tree
+*/\
+T fenwick_prefix_sum_##typename(fenwick_##typename *self, size_t end) {\
+    if (end > self->tree.len) {\
+        end = self->tree.len;\
     }\
-    if (!found) {\
-        return false;\
+    T sum = 0;\
+    for (size_t i = end; i > 0; i -= i & -i) {\
+        sum += self->tree.buf[i - 1];\
     }\
-\
-    self->entries.buf[index].value = value;\
-    return true;\
+    return sum;\
 }\
-bool map_remove_##typenames(map_##typenames *self, K key) {\
-    size_t index = self->hash(key) % self->entries.cap;\
-    bool found = false;\
-    while (self->entries.buf[index].active) {\
-        if (self->key_compare(self->entries.buf[index].key, key)) {\
-            found = true;\
-            break;\
-        }\
-        index = (index + 1) % self->entries.cap;\
+/*
+    returns the sum of the values in [begin, end) as an option
+    if the range is out of bounds, returns .ok = false
+*/\
+option_##typename fenwick_range_sum_##typename(fenwick_##typename *self, size_t begin, size_t end) {\
+    if (begin > end || end > self->tree.len) {\
+        return (option_##typename){.ok = false};\
     }\
-    if (!found) {\
-        return false;\
+    T sum = fenwick_prefix_sum_##typename(self, end) - fenwick_prefix_sum_##typename(self, begin);\
+    return (option_##typename){.ok = true, .value = sum};\
+}\
+/*
+    returns the value at index as an option, costs two prefix sums
+    if index is out of bounds, returns .ok = false
+*/\
+option_##typename fenwick_at_##typename(fenwick_##typename *self, size_t index) {\
+    return fenwick_range_sum_##typename(self, index, index + 1);\
+}\
+/*
+    overwrites the value at index
+    returns ERR_INDEX_OUT_OF_BOUNDS if index is out of bounds
+*/\
+result_##typename fenwick_set_##typename(fenwick_##typename *self, size_t index, T value) {\
+    option_##typename old = fenwick_at_##typename(self, index);\
+    if (!old.ok) {\
+        return (result_##typename){.err = ERR_INDEX_OUT_OF_BOUNDS};\
     }\
-    self->entries.buf[index].active = false;\
-    self->active_count -= 1;\
-    return true;\
+    return fenwick_add_##typename(self, index, value - old.value);\
+}\
+void fenwick_deinit_##typename(fenwick_##typename *self) {\
+    dyn_deinit_##typename(&self->tree);\
 }\
 
-// little macro to iterate over the active entries in a map
-#define map_iter(entry, iter, map, codeblock)\
-for (size_t iter = 0; iter < map.entries.cap; iter++) {\
-    typeof(map.entries.buf[0]) entry = map.entries.buf[iter];\
-    if (entry.active) {\
-        codeblock\
+// generates fenwick tree with it's dependencies such as the dynamic array
+#define gen_fenwick_with_deps(T, typename)\
+gen_dyn_with_deps(T, typename)\
+gen_fenwick(T, typename)
+
+// bottom up segment tree for any associative combine function (sum, min, max, gcd, ...)
+// leaves live in .tree.buf[len..2 * len), node i combines nodes 2i and 2i + 1
+// .identity must satisfy combine(identity, x) == x, i.e. 0 for sums or the type's max for min
+// NOTE: needs gen_dyn_with_deps(T, typename) to be generated first
+#define gen_segtree(T, typename)\
+typedef struct {\
+    dyn_##typename tree;\
+    size_t len;\
+    T identity;\
+    T (*combine)(T, T);\
+} segtree_##typename;\
+/*
+    initialise a segment tree of len identity values
+
+    NOTE: call segtree_deinit to free
+*/\
+segtree_##typename segtree_init_##typename(size_t len, T identity, T combine(T, T)) {\
+    dyn_##typename tree = dyn_init_with_cap_##typename(2 * len);\
+    tree.len = 2 * len;\
+    for (size_t i = 0; i < tree.len; i++) {\
+        tree.buf[i] = identity;\
+    }\
+    return (segtree_##typename){\
+        .tree = tree,\
+        .len = len,\
+        .identity = identity,\
+        .combine = combine,\
+    };\
+}\
+/*
+    builds a segment tree over a copy of values in O(n)
+
+    NOTE: call segtree_deinit to free
+*/\
+segtree_##typename segtree_from_dyn_##typename(dyn_##typename *values, T identity, T combine(T, T)) {\
+    size_t len = values->len;\
+    dyn_##typename tree = dyn_init_with_cap_##typename(2 * len);\
+    tree.len = 2 * len;\
+    memcpy(tree.buf + len, values->buf, sizeof(T) * len);\
+    for (size_t i = len; i-- > 1;) {\
+        tree.buf[i] = combine(tree.buf[2 * i], tree.buf[2 * i + 1]);\
+    }\
+    if (len) {\
+        tree.buf[0] = identity;\
+    }\
+    return (segtree_##typename){\
+        .tree = tree,\
+        .len = len,\
+        .identity = identity,\
+        .combine = combine,\
+    };\
+}\
+/* 
+    returns the elem at index as an option
+    if index is out of bounds, returns .ok = false
+*/\
+option_##typename segtree_at_##typename(segtree_##typename *self, size_t index) {\
+    if (index >= self->len) {\
+        return (option_##typename){.ok = false};\
+    }\
+    return (option_##typename){.ok = true, .value = self->tree.buf[self->len + index]};\
+}\
+/*
+    overwrites the value at index and recombines its parents in O(log n)
+    returns ERR_INDEX_OUT_OF_BOUNDS if index is out of bounds
+*/\
+result_##typename segtree_set_##typename(segtree_##typename *self, size_t index, T value) {\
+    if (index >= self->len) {\
+        return (result_##typename){.err = ERR_INDEX_OUT_OF_BOUNDS};\
+    }\
+    T* tree = self->tree.buf;\
+    size_t i = self->len + index;\
+    tree[i] = value;\
+    for (i /= 2; i >= 1; i /= 2) {\
+        tree[i] = self->combine(tree[2 * i], tree[2 * i + 1]);\
+    }\
+    return (result_##typename){.err = ERR_NONE};\
+}\
+/*
+    combines the values in [begin, end) in O(log n), keeping left to right order for non commutative functions
+    if the range is out of bounds, returns .ok = false
+    an empty range returns .identity
+*/\
+option_##typename segtree_query_##typename(segtree_##typename *self, size_t begin, size_t end) {\
+    if (begin > end || end > self->len) {\
+        return (option_##typename){.ok = false};\
+    }\
+    T* tree = self->tree.buf;\
+    T left = self->identity;\
+    T right = self->identity;\
+    for (size_t l = begin + self->len, r = end + self->len; l < r; l /= 2, r /= 2) {\
+        if (l & 1) {\
+            left = self->combine(left, tree[l++]);\
+        }\
+        if (r & 1) {\
+            right = self->combine(tree[--r], right);\
+        }\
     }\
+    return (option_##typename){.ok = true, .value = self->combine(left, right)};\
+}\
+void segtree_deinit_##typename(segtree_##typename *self) {\
+    dyn_deinit_##typename(&self->tree);\
+    self->len = 0;\
+}\
+
+// generates segment tree with it's dependencies such as the dynamic array
+#define gen_segtree_with_deps(T, typename)\
+gen_dyn_with_deps(T, typename)\
+gen_segtree(T, typename)
+
+
+
+/* ################# THREAD POOL ################# */
+
+
+
+// counts the tasks of a group that haven't finished yet, tp_wait blocks until it hits 0
+typedef struct {
+    atomic_size_t pending;
+} tp_group;
+
+tp_group tp_group_init() {
+    return (tp_group){.pending = 0};
 }
 
-// a hashing function for string keys
-size_t hash_djb2(char* str) {
-    size_t hash = 5381;
-    for (size_t i = 0; i < strlen(str); i++) {
-        if (str[i] == 0) {
+typedef struct {
+    void (*fn)(void* ctx);
+    void* ctx;
+    tp_group* group;
+} tp_task;
+
+// ring of task slots, cap is a power of two
+// grown arrays are kept in .prev until the deque is freed since a thief may still be reading one
+typedef struct tp_deque_array {
+    size_t cap;
+    struct tp_deque_array* prev;
+    _Atomic(tp_task*) slots[];
+} tp_deque_array;
+
+// chase-lev deque, the owning worker pushes and takes at the bottom and other threads steal from the top
+// so the owner only races with thieves over the last task
+typedef struct {
+    _Atomic int64_t top;
+    _Atomic int64_t bottom;
+    _Atomic(tp_deque_array*) array;
+} tp_deque;
+
+struct threadpool;
+typedef struct {
+    tp_deque deque;
+    struct threadpool* pool;
+    uint64_t seed;
+    // keeps neighbouring workers' deques off each other's cache lines
+    char pad[64];
+} tp_worker;
+
+typedef struct threadpool {
+    tp_worker* workers;
+    pthread_t* threads;
+    size_t thread_count;
+    // tasks spawned from threads outside the pool, a fifo under lock
+    tp_task** injected;
+    size_t injected_head;
+    size_t injected_len;
+    size_t injected_cap;
+    // injected_len - injected_head, readable without the lock
+    atomic_size_t injected_count;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    // tasks spawned but not yet taken, workers only sleep when it's 0
+    atomic_size_t queued;
+    atomic_size_t sleeping;
+    atomic_bool stop;
+} threadpool;
+
+// the worker running on this thread, NULL outside of a pool
+static _Thread_local tp_worker* tp_current = NULL;
+
+/* NOTE: you usually won't have to call this yourself */
+tp_deque_array* tp_deque_array_alloc(size_t cap) {
+    tp_deque_array* array = (tp_deque_array*)malloc(sizeof(tp_deque_array) + cap * sizeof(_Atomic(tp_task*)));
+    array->cap = cap;
+    array->prev = NULL;
+    return array;
+}
+/* NOTE: you usually won't have to call this yourself */
+void tp_deque_init(tp_deque *self) {
+    atomic_init(&self->top, 0);
+    atomic_init(&self->bottom, 0);
+    atomic_init(&self->array, tp_deque_array_alloc(64));
+}
+/*
+    pushes a task at the bottom, only the owning worker may call this
+    NOTE: you usually won't have to call this yourself
+*/
+void tp_deque_push(tp_deque *self, tp_task* task) {
+    int64_t b = atomic_load_explicit(&self->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&self->top, memory_order_acquire);
+    tp_deque_array* array = atomic_load_explicit(&self->array, memory_order_relaxed);
+    if (b - t >= (int64_t)array->cap) {
+        tp_deque_array* grown = tp_deque_array_alloc(array->cap * 2);
+        for (int64_t i = t; i < b; i++) {
+            tp_task* moved = atomic_load_explicit(&array->slots[i & (array->cap - 1)], memory_order_relaxed);
+            atomic_store_explicit(&grown->slots[i & (grown->cap - 1)], moved, memory_order_relaxed);
+        }
+        grown->prev = array;
+        atomic_store_explicit(&self->array, grown, memory_order_release);
+        array = grown;
+    }
+    atomic_store_explicit(&array->slots[b & (array->cap - 1)], task, memory_order_relaxed);
+    // publishes the slot and the task it points to for thieves
+    atomic_store_explicit(&self->bottom, b + 1, memory_order_release);
+}
+/*
+    takes the most recently pushed task, only the owning worker may call this
+    returns NULL if it's empty or a thief won the last task
+    NOTE: you usually won't have to call this yourself
+*/
+tp_task* tp_deque_take(tp_deque *self) {
+    int64_t b = atomic_load_explicit(&self->bottom, memory_order_relaxed) - 1;
+    tp_deque_array* array = atomic_load_explicit(&self->array, memory_order_relaxed);
+    atomic_store_explicit(&self->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&self->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&self->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    tp_task* task = atomic_load_explicit(&array->slots[b & (array->cap - 1)], memory_order_relaxed);
+    if (t == b) {
+        // last task, race the thieves for it through top
+        if (!atomic_compare_exchange_strong_explicit(&self->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            task = NULL;
+        }
+        atomic_store_explicit(&self->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+/*
+    steals the oldest task, any thread may call this
+    returns NULL if it's empty or another thread took the task first
+    NOTE: you usually won't have to call this yourself
+*/
+tp_task* tp_deque_steal(tp_deque *self) {
+    int64_t t = atomic_load_explicit(&self->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&self->bottom, memory_order_acquire);
+    if (t >= b) {
+        return NULL;
+    }
+    tp_deque_array* array = atomic_load_explicit(&self->array, memory_order_acquire);
+    tp_task* task = atomic_load_explicit(&array->slots[t & (array->cap - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&self->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return task;
+}
+/* NOTE: you usually won't have to call this yourself */
+void tp_deque_deinit(tp_deque *self) {
+    tp_deque_array* array = atomic_load_explicit(&self->array, memory_order_relaxed);
+    while (array) {
+        tp_deque_array* prev = array->prev;
+        free(array);
+        array = prev;
+    }
+}
+
+/*
+    finds a task to run: the worker's own deque first, then the injected tasks, then stealing
+    worker is NULL when called from a thread outside the pool
+    NOTE: you usually won't have to call this yourself
+*/
+tp_task* tp_find_task(threadpool *self, tp_worker* worker, uint64_t* seed) {
+    if (worker) {
+        tp_task* task = tp_deque_take(&worker->deque);
+        if (task) {
+            return task;
+        }
+    }
+    if (atomic_load_explicit(&self->injected_count, memory_order_relaxed)) {
+        tp_task* task = NULL;
+        pthread_mutex_lock(&self->lock);
+        if (self->injected_head < self->injected_len) {
+            task = self->injected[self->injected_head++];
+            atomic_fetch_sub_explicit(&self->injected_count, 1, memory_order_relaxed);
+            if (self->injected_head == self->injected_len) {
+                self->injected_head = 0;
+                self->injected_len = 0;
+            }
+        }
+        pthread_mutex_unlock(&self->lock);
+        if (task) {
+            return task;
+        }
+    }
+    // xorshift picks where to start so thieves spread over the victims
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    size_t start = *seed % self->thread_count;
+    for (size_t i = 0; i < self->thread_count; i++) {
+        tp_worker* victim = &self->workers[(start + i) % self->thread_count];
+        if (victim == worker) {
+            continue;
+        }
+        tp_task* task = tp_deque_steal(&victim->deque);
+        if (task) {
+            return task;
+        }
+    }
+    return NULL;
+}
+/* NOTE: you usually won't have to call this yourself */
+void tp_run(threadpool *self, tp_task* task) {
+    atomic_fetch_sub(&self->queued, 1);
+    tp_group* group = task->group;
+    task->fn(task->ctx);
+    free(task);
+    // makes everything the task wrote visible to tp_wait, the group may be gone right after
+    // tp_wait bumps sleeping before it reads pending, so one of the two always sees the other
+    if (atomic_fetch_sub(&group->pending, 1) == 1 && atomic_load(&self->sleeping)) {
+        pthread_mutex_lock(&self->lock);
+        pthread_cond_broadcast(&self->wake);
+        pthread_mutex_unlock(&self->lock);
+    }
+}
+/* NOTE: you usually won't have to call this yourself */
+void* tp_worker_main(void* arg) {
+    tp_worker* worker = (tp_worker*)arg;
+    threadpool* self = worker->pool;
+    tp_current = worker;
+    for (;;) {
+        tp_task* task = tp_find_task(self, worker, &worker->seed);
+        if (task) {
+            tp_run(self, task);
+            continue;
+        }
+        pthread_mutex_lock(&self->lock);
+        // tp_spawn bumps queued before it reads sleeping, so one of the two always sees the other
+        atomic_fetch_add(&self->sleeping, 1);
+        while (atomic_load(&self->queued) == 0 && !atomic_load(&self->stop)) {
+            pthread_cond_wait(&self->wake, &self->lock);
+        }
+        atomic_fetch_sub(&self->sleeping, 1);
+        bool exit = atomic_load(&self->queued) == 0 && atomic_load(&self->stop);
+        pthread_mutex_unlock(&self->lock);
+        if (exit) {
             break;
         }
-        hash = ((hash << 5) + hash) + str[i];
+        // a queued task that couldn't be found yet is being taken by another thread
+        sched_yield();
     }
-    return hash;
+    tp_current = NULL;
+    return NULL;
 }
 
-// string equal function that just returns if two strings are the same
-// this is in the header for convenience when using a map with char* keys
-bool str_equal(char* one, char* two) {
-    return strcmp(one, two) == 0;
+/*
+    starts a pool of thread_count workers that each own a deque and steal from the others when theirs is empty
+    if thread_count is 0, uses the number of online cpus
+
+    NOTE: call tp_deinit to free
+*/
+threadpool* tp_init(size_t thread_count) {
+    if (thread_count == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpus > 0 ? (size_t)cpus : 1;
+    }
+    threadpool* self = (threadpool*)malloc(sizeof(threadpool));
+    self->workers = (tp_worker*)malloc(sizeof(tp_worker) * thread_count);
+    self->threads = (pthread_t*)malloc(sizeof(pthread_t) * thread_count);
+    self->thread_count = thread_count;
+    self->injected = NULL;
+    self->injected_head = 0;
+    self->injected_len = 0;
+    self->injected_cap = 0;
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->wake, NULL);
+    atomic_init(&self->injected_count, 0);
+    atomic_init(&self->queued, 0);
+    atomic_init(&self->sleeping, 0);
+    atomic_init(&self->stop, false);
+    for (size_t i = 0; i < thread_count; i++) {
+        tp_deque_init(&self->workers[i].deque);
+        self->workers[i].pool = self;
+        self->workers[i].seed = 0x9e3779b97f4a7c15ull * (i + 1);
+    }
+    for (size_t i = 0; i < thread_count; i++) {
+        pthread_create(&self->threads[i], NULL, tp_worker_main, &self->workers[i]);
+    }
+    return self;
+}
+/*
+    queues fn(ctx) as part of group, it runs on some worker later
+    from inside a task it goes on the current worker's deque, from anywhere else onto a shared queue
+*/
+void tp_spawn(threadpool *self, tp_group* group, void (*fn)(void* ctx), void* ctx) {
+    tp_task* task = (tp_task*)malloc(sizeof(tp_task));
+    *task = (tp_task){.fn = fn, .ctx = ctx, .group = group};
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    // counted before it's published so a thief taking it straight away can't take queued below 0
+    atomic_fetch_add(&self->queued, 1);
+    if (tp_current && tp_current->pool == self) {
+        tp_deque_push(&tp_current->deque, task);
+    } else {
+        pthread_mutex_lock(&self->lock);
+        if (self->injected_len == self->injected_cap) {
+            self->injected_cap = self->injected_cap ? self->injected_cap * 2 : 64;
+            self->injected = (tp_task**)realloc(self->injected, sizeof(tp_task*) * self->injected_cap);
+        }
+        self->injected[self->injected_len++] = task;
+        atomic_fetch_add_explicit(&self->injected_count, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&self->lock);
+    }
+    if (atomic_load(&self->sleeping)) {
+        pthread_mutex_lock(&self->lock);
+        pthread_cond_signal(&self->wake);
+        pthread_mutex_unlock(&self->lock);
+    }
+}
+/*
+    blocks until every task spawned into group has finished
+    the calling thread runs queued tasks while it waits, so tasks can spawn and wait on their own groups,
+    and sleeps when there is nothing to run until the group finishes or more tasks are queued
+*/
+void tp_wait(threadpool *self, tp_group* group) {
+    tp_worker* worker = tp_current && tp_current->pool == self ? tp_current : NULL;
+    uint64_t seed = (uint64_t)(uintptr_t)group | 1;
+    while (atomic_load(&group->pending) > 0) {
+        tp_task* task = tp_find_task(self, worker, worker ? &worker->seed : &seed);
+        if (task) {
+            tp_run(self, task);
+            continue;
+        }
+        pthread_mutex_lock(&self->lock);
+        atomic_fetch_add(&self->sleeping, 1);
+        while (atomic_load(&group->pending) > 0 && atomic_load(&self->queued) == 0) {
+            pthread_cond_wait(&self->wake, &self->lock);
+        }
+        atomic_fetch_sub(&self->sleeping, 1);
+        pthread_mutex_unlock(&self->lock);
+    }
 }
 
-// see if two numbers of the same type are equal
-// this is in the header for convenience when using a map with number keys
-// might seem dumb but since map needs a function to compare generic types, this is needed
-#define gen_num_equal(T, typename)\
-bool num_equal_##typename(T one, T two) {\
-    return one == two;\
-}\
+// one half of a tp_parallel_for range, split again until it's at most grain long
+typedef struct {
+    threadpool* pool;
+    tp_group* group;
+    size_t begin;
+    size_t end;
+    size_t grain;
+    void (*fn)(size_t begin, size_t end, void* ctx);
+    void* ctx;
+} tp_range;
+
+/* NOTE: you usually won't have to call this yourself */
+void tp_range_run(void* arg) {
+    tp_range* range = (tp_range*)arg;
+    // hands the upper halves to the deque so idle workers steal big pieces first
+    while (range->end - range->begin > range->grain) {
+        size_t mid = range->begin + (range->end - range->begin) / 2;
+        tp_range* upper = (tp_range*)malloc(sizeof(tp_range));
+        *upper = *range;
+        upper->begin = mid;
+        tp_spawn(range->pool, range->group, tp_range_run, upper);
+        range->end = mid;
+    }
+    range->fn(range->begin, range->end, range->ctx);
+    free(range);
+}
+/*
+    calls fn(chunk_begin, chunk_end, ctx) over [begin, end) split into chunks of at most grain indices
+    the chunks run in parallel and it returns once all of them are done
+    if grain is 0, uses 1
+*/
+void tp_parallel_for(threadpool *self, size_t begin, size_t end, size_t grain, void (*fn)(size_t begin, size_t end, void* ctx), void* ctx) {
+    if (begin >= end) {
+        return;
+    }
+    tp_group group = tp_group_init();
+    tp_range* range = (tp_range*)malloc(sizeof(tp_range));
+    *range = (tp_range){
+        .pool = self,
+        .group = &group,
+        .begin = begin,
+        .end = end,
+        .grain = grain ? grain : 1,
+        .fn = fn,
+        .ctx = ctx,
+    };
+    tp_range_run(range);
+    tp_wait(self, &group);
+}
+/* finishes every queued task, then stops and frees the pool */
+void tp_deinit(threadpool *self) {
+    pthread_mutex_lock(&self->lock);
+    atomic_store(&self->stop, true);
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->lock);
+    for (size_t i = 0; i < self->thread_count; i++) {
+        pthread_join(self->threads[i], NULL);
+    }
+    for (size_t i = 0; i < self->thread_count; i++) {
+        tp_deque_deinit(&self->workers[i].deque);
+    }
+    pthread_mutex_destroy(&self->lock);
+    pthread_cond_destroy(&self->wake);
+    free(self->injected);
+    free(self->workers);
+    free(self->threads);
+    free(self);
+}
 
 #endif // COMMONS_H